@@ -1,13 +1,17 @@
-from typing import IO, Any, Optional
+import os
+from typing import IO, Any, Optional, Union
 
-from .py_json5 import dumps, loads
+from .cache import Cache, CacheInfo, FrozenDict, default_cache, freeze
+from .py_json5 import JSON5DecodeError, dumps, loads, transcode, validate
+from .stream import iterparse
 
 
-def load(fp: IO[str]) -> Any:
+def load(fp: IO[str], columnar: Union[bool, str] = False) -> Any:
     """
     Read JSON5 text from a file-like object and parse into Python data.
+    'columnar' is passed on to loads().
     """
-    return loads(fp.read())
+    return loads(fp.read(), columnar=columnar)
 
 
 def dump(obj: Any, fp: IO[str], indent: Optional[int] = None) -> None:
@@ -18,4 +22,32 @@ def dump(obj: Any, fp: IO[str], indent: Optional[int] = None) -> None:
     fp.write(text)
 
 
-__all__ = ["loads", "dumps", "load", "dump"]
+def load_file(path: Union[str, "os.PathLike[str]"], cache: Union[bool, Cache] = False) -> Any:
+    """
+    Read and parse a JSON5 file.
+    With cache=True (or a Cache instance) unchanged files are served from
+    the cache as read-only data instead of being re-parsed.
+    """
+    if cache is True:
+        cache = default_cache
+    if isinstance(cache, Cache):
+        return cache.load(path)
+    with open(path, encoding="utf-8") as f:
+        return loads(f.read())
+
+
+__all__ = [
+    "loads",
+    "dumps",
+    "load",
+    "dump",
+    "validate",
+    "transcode",
+    "iterparse",
+    "JSON5DecodeError",
+    "load_file",
+    "Cache",
+    "CacheInfo",
+    "FrozenDict",
+    "freeze",
+]
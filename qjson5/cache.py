@@ -0,0 +1,138 @@
+import copy
+import os
+import threading
+from collections import OrderedDict
+from typing import Any, NamedTuple, Union
+
+from .py_json5 import loads
+
+PathLike = Union[str, bytes, "os.PathLike[str]", "os.PathLike[bytes]"]
+
+
+class CacheInfo(NamedTuple):
+    hits: int
+    misses: int
+    maxsize: int
+    currsize: int
+
+
+class FrozenDict(dict):
+    """
+    Read-only dict returned for cached objects.
+    Still a dict subclass, so `dumps`, `==` and `isinstance` keep working.
+    """
+
+    __slots__ = ()
+
+    def _readonly(self, *args, **kwargs):
+        raise TypeError("cached JSON5 objects are read-only")
+
+    __setitem__ = __delitem__ = __ior__ = _readonly
+    clear = pop = popitem = setdefault = update = _readonly
+
+    def __hash__(self):
+        return hash(frozenset(self.items()))
+
+    # copy and pickle would otherwise refill an empty instance through
+    # __setitem__; build it from the items instead.
+    def __reduce__(self):
+        return (FrozenDict, (dict(self),))
+
+    def __copy__(self):
+        return self
+
+    def __deepcopy__(self, memo):
+        return FrozenDict((k, copy.deepcopy(v, memo)) for k, v in self.items())
+
+
+def freeze(obj: Any) -> Any:
+    """
+    Deep-convert parsed JSON5 data into an immutable view:
+    dicts become FrozenDict, lists become tuples.
+    """
+    if isinstance(obj, dict):
+        return FrozenDict((k, freeze(v)) for k, v in obj.items())
+    if isinstance(obj, list):
+        return tuple(freeze(v) for v in obj)
+    return obj
+
+
+class Cache:
+    """
+    Bounded LRU cache of parsed JSON5 files.
+
+    Entries are keyed on the absolute path and validated against the file's
+    mtime (ns), size and inode on every lookup, so an unchanged file costs a
+    single stat() call instead of a read and a full parse.
+    """
+
+    def __init__(self, maxsize: int = 128, frozen: bool = True):
+        if maxsize < 1:
+            raise ValueError("maxsize must be >= 1")
+        self.maxsize = maxsize
+        self.frozen = frozen
+        self._entries: "OrderedDict[str, tuple]" = OrderedDict()
+        self._lock = threading.Lock()
+        self._hits = 0
+        self._misses = 0
+
+    def load(self, path: PathLike) -> Any:
+        """
+        Return the parsed contents of 'path', re-parsing only if the file changed.
+        """
+        key = os.path.abspath(os.fsdecode(path))
+        st = os.stat(key)
+        stamp = (st.st_mtime_ns, st.st_size, st.st_ino)
+
+        with self._lock:
+            entry = self._entries.get(key)
+            if entry is not None and entry[0] == stamp:
+                self._entries.move_to_end(key)
+                self._hits += 1
+                return entry[1]
+            self._misses += 1
+
+        with open(key, encoding="utf-8") as f:
+            value = loads(f.read())
+        if self.frozen:
+            value = freeze(value)
+
+        with self._lock:
+            self._entries[key] = (stamp, value)
+            self._entries.move_to_end(key)
+            while len(self._entries) > self.maxsize:
+                self._entries.popitem(last=False)
+        return value
+
+    def invalidate(self, path: PathLike) -> None:
+        """
+        Drop the entry for 'path', if any.
+        """
+        key = os.path.abspath(os.fsdecode(path))
+        with self._lock:
+            self._entries.pop(key, None)
+
+    def clear(self) -> None:
+        """
+        Drop all entries and reset the hit/miss counters.
+        """
+        with self._lock:
+            self._entries.clear()
+            self._hits = 0
+            self._misses = 0
+
+    def info(self) -> CacheInfo:
+        with self._lock:
+            return CacheInfo(self._hits, self._misses, self.maxsize, len(self._entries))
+
+    def __len__(self) -> int:
+        with self._lock:
+            return len(self._entries)
+
+    def __contains__(self, path: PathLike) -> bool:
+        key = os.path.abspath(os.fsdecode(path))
+        with self._lock:
+            return key in self._entries
+
+
+default_cache = Cache()
@@ -1,6 +1,6 @@
 #include "json5.h"
+#include "simd.h"
 #include <string.h>
-#include <ctype.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <math.h>
@@ -13,486 +13,602 @@
 #define INLINE inline
 #endif
 
-#define RAISE(msg) do { PyErr_SetString(PyExc_ValueError, (msg)); return NULL; } while(0)
-#define IS_JS_IDENT_START(c) ((c) == '_' || (c) == '$' || isalpha((unsigned char)(c)))
-#define IS_JS_IDENT_PART(c)  ((c) == '_' || (c) == '$' || isalnum((unsigned char)(c)))
+#define BUILD_INLINE_FRAMES 32
 
-// Forward declarations
-static INLINE void skip_whitespace(const char **p);
-static INLINE PyObject* parse_value(const char **p);
-static PyObject* parse_object(const char **p);
-static PyObject* parse_array(const char **p);
-static PyObject* parse_string(const char **p);
-static INLINE PyObject* parse_number(const char **p);
-static INLINE PyObject* parse_true(const char **p);
-static INLINE PyObject* parse_false(const char **p);
-static INLINE PyObject* parse_null(const char **p);
+/*
+ * Building: a json5_callbacks consumer that turns parser events into
+ * Python objects. Each open container is a frame owning its dict or
+ * list, plus the pending key for dicts; a finished container is handed
+ * to its parent frame (or becomes the result).
+ *
+ * In columnar mode an array whose first element is an object is
+ * collected as a record array: the object's keys become columns and
+ * each record is pushed under a frame with no container, appending its
+ * values straight to the columns. Both frames share the record_set.
+ */
+typedef struct record_set record_set;
+
+typedef struct {
+    PyObject *container;   /* NULL for a record being split into columns */
+    PyObject *key;
+    record_set *records;   /* record array (or record) frames only */
+} build_frame;
+
+typedef struct {
+    build_frame inline_frames[BUILD_INLINE_FRAMES];
+    build_frame *frames;
+    size_t depth;
+    size_t capacity;
+    PyObject *result;
+    int columnar;          /* COLUMNAR_* */
+    PyObject *array_type;  /* array.array, for COLUMNAR_PACKED */
+} builder;
+
+static void records_free(record_set *rs);
+static int records_add(build_frame *f, PyObject *v);
 
-/* Forward declaration for fastNum */
-static PyObject* fastNum(const char *start, const char **end);
+static void builder_init(builder *b) {
+    b->frames = b->inline_frames;
+    b->depth = 0;
+    b->capacity = BUILD_INLINE_FRAMES;
+    b->result = NULL;
+    b->columnar = COLUMNAR_OFF;
+    b->array_type = NULL;
+}
+
+static void builder_free(builder *b) {
+    while (b->depth > 0) {
+        build_frame *f = &b->frames[--b->depth];
+        if (f->records && f->container) {
+            records_free(f->records);
+        }
+        Py_XDECREF(f->container);
+        Py_XDECREF(f->key);
+    }
+    if (b->frames != b->inline_frames) {
+        PyMem_Free(b->frames);
+    }
+    Py_CLEAR(b->array_type);
+}
 
 /*
- * skip_whitespace:
- * Advances the pointer over whitespace and comments.
+ * build_add:
+ * Stores a finished value (stealing the reference) in the innermost
+ * container, or as the result at the top level.
  */
-static INLINE void skip_whitespace(const char **ref) {
-    const char *p = *ref;
-    while (1) {
-        while ((unsigned char)*p <= ' ' && *p != '\0') {
-            p++;
-        }
-        if (*p == '\0') {
-            break;
-        }
-        if (p[0] == '/' && p[1] == '/') {
-            p += 2;
-            while (*p && *p != '\n') {
-                p++;
-            }
-            continue;
+static INLINE int build_add(builder *b, PyObject *v) {
+    if (!v) {
+        return -1;
+    }
+    if (b->depth == 0) {
+        b->result = v;
+        return 0;
+    }
+    build_frame *f = &b->frames[b->depth - 1];
+    int rc;
+    if (f->key) {
+        rc = PyDict_SetItem(f->container, f->key, v);
+        Py_CLEAR(f->key);
+    } else if (!f->records) {
+        rc = PyList_Append(f->container, v);
+    } else {
+        return records_add(f, v);
+    }
+    Py_DECREF(v);
+    return rc;
+}
+
+static INLINE build_frame* build_push(builder *b) {
+    if (b->depth == b->capacity) {
+        size_t capacity = b->capacity * 2;
+        build_frame *tmp = (build_frame*)PyMem_Malloc(capacity * sizeof(build_frame));
+        if (!tmp) {
+            PyErr_NoMemory();
+            return NULL;
         }
-        if (p[0] == '/' && p[1] == '*') {
-            p += 2;
-            while (*p) {
-                if (p[0] == '*' && p[1] == '/') {
-                    p += 2;
-                    break;
-                }
-                p++;
-            }
-            continue;
+        memcpy(tmp, b->frames, b->depth * sizeof(build_frame));
+        if (b->frames != b->inline_frames) {
+            PyMem_Free(b->frames);
         }
-        break;
+        b->frames = tmp;
+        b->capacity = capacity;
     }
-    *ref = p;
+    build_frame *f = &b->frames[b->depth++];
+    f->container = NULL;
+    f->key = NULL;
+    f->records = NULL;
+    return f;
 }
 
-/*
- * parse_value:
- * Detects the next token and branches accordingly.
- */
-static INLINE PyObject* parse_value(const char **ref) {
-    skip_whitespace(ref);
-    const char *p = *ref;
-    char c = *p;
-
-    switch (c) {
-        case '{':
-            (*ref)++;
-            return parse_object(ref);
-        case '[':
-            (*ref)++;
-            return parse_array(ref);
-        case '"':
-        case '\'':
-            return parse_string(ref);
-        case 't':
-            if (p[1] == 'r' && p[2] == 'u' && p[3] == 'e') {
-                return parse_true(ref);
-            }
-            break;
-        case 'f':
-            if (p[1] == 'a' && p[2] == 'l' && p[3] == 's' && p[4] == 'e') {
-                return parse_false(ref);
-            }
-            break;
-        case 'n':
-            if (p[1] == 'u' && p[2] == 'l' && p[3] == 'l') {
-                return parse_null(ref);
-            }
-            break;
-        default:
-            if (c == '-' || c == '+' || c == '.' || (c >= '0' && c <= '9')) {
-                return parse_number(ref);
-            }
-            break;
+static INLINE int build_open(builder *b, PyObject *container) {
+    if (!container) {
+        return -1;
+    }
+    build_frame *f = build_push(b);
+    if (!f) {
+        Py_DECREF(container);
+        return -1;
     }
-    RAISE("Unexpected token");
+    f->container = container;
+    return 0;
+}
+
+static INLINE int build_close(builder *b) {
+    PyObject *container = b->frames[--b->depth].container;
+    return build_add(b, container);
 }
 
 /*
- * parse_object:
- * Creates a Python dict from JSON5 object syntax.
+ * make_string:
+ * Decodes a string or key token straight into a PyUnicode of the
+ * narrowest kind; the scanner already measured its length and maximum
+ * code point, so there is no intermediate buffer or second decode.
  */
-static PyObject* parse_object(const char **ref) {
-    PyObject *d = PyDict_New();
-    if (!d) {
+static INLINE PyObject* make_string(const json5_token *tok) {
+    PyObject *s = PyUnicode_New((Py_ssize_t)tok->length, tok->max_char);
+    if (!s) {
         return NULL;
     }
-    skip_whitespace(ref);
+    json5_decode_string(tok, PyUnicode_DATA(s), (int)PyUnicode_KIND(s));
+    return s;
+}
 
-    if (**ref == '}') {
-        (*ref)++;
-        return d;
-    }
+/*
+ * Columnar decoding: record_set holds one column per key of the first
+ * record. Later records must repeat those keys in the same order; their
+ * key tokens are compared byte-for-byte against the first record's
+ * (the builder only runs over a whole document, so those spans stay
+ * valid), so each key is decoded once per column. With COLUMNAR_PACKED
+ * numeric columns stay as raw int64/double until a value of another
+ * kind arrives.
+ */
+#define COLUMN_OBJECTS 0
+#define COLUMN_INTS    1
+#define COLUMN_FLOATS  2
 
-    while (**ref) {
-        skip_whitespace(ref);
-        PyObject *k = NULL;
-        char c = **ref;
+#define EXACT_DOUBLE_INT 9007199254740992LL  /* 2^53, bound (exclusive) of packed ints in a double column */
 
-        if (c == '"' || c == '\'') {
-            k = parse_string(ref);
-            if (!k) {
-                Py_DECREF(d);
-                return NULL;
-            }
-        } else {
-            const char *start = *ref;
-            while (**ref && **ref != ':' && (unsigned char)**ref > ' '
-                   && **ref != ',' && **ref != '}' && **ref != '/') {
-                (*ref)++;
-            }
-            size_t length = (size_t)(*ref - start);
-            if (length == 0) {
-                Py_DECREF(d);
-                RAISE("Invalid key");
-            }
-            if (!IS_JS_IDENT_START((unsigned char)start[0])) {
-                Py_DECREF(d);
-                RAISE("Invalid unquoted key start");
-            }
-            for (size_t i = 1; i < length; i++) {
-                if (!IS_JS_IDENT_PART((unsigned char)start[i])) {
-                    Py_DECREF(d);
-                    RAISE("Invalid unquoted key char");
-                }
-            }
-            k = PyUnicode_FromStringAndSize(start, (Py_ssize_t)length);
-            if (!k) {
-                Py_DECREF(d);
-                return NULL;
-            }
-        }
+typedef union {
+    long long i;
+    double d;
+} packed_number;
 
-        skip_whitespace(ref);
-        if (**ref != ':') {
-            Py_DECREF(k);
-            Py_DECREF(d);
-            RAISE("Missing colon");
-        }
-        (*ref)++;
+typedef struct {
+    PyObject *name;
+    const char *span;      /* the key as written in the first record */
+    size_t span_len;
+    int kind;
+    PyObject *values;      /* COLUMN_OBJECTS */
+    packed_number *packed; /* COLUMN_INTS / COLUMN_FLOATS */
+    size_t len;
+    size_t cap;
+} column;
+
+struct record_set {
+    column *columns;
+    size_t count;
+    size_t capacity;
+    size_t records;        /* finished records */
+    size_t field;          /* keys seen in the current record */
+    int complete;          /* first record finished, columns fixed */
+};
+
+static void records_free(record_set *rs) {
+    for (size_t i = 0; i < rs->count; i++) {
+        Py_XDECREF(rs->columns[i].name);
+        Py_XDECREF(rs->columns[i].values);
+        PyMem_Free(rs->columns[i].packed);
+    }
+    PyMem_Free(rs->columns);
+    PyMem_Free(rs);
+}
+
+/*
+ * column_get:
+ * Returns a new reference to value r. A packed double that is integral
+ * and below 2^53 in magnitude was an integer in the input: the scanner
+ * hands every such number over as one.
+ */
+static PyObject* column_get(const column *c, size_t r) {
+    if (c->kind == COLUMN_OBJECTS) {
+        PyObject *v = PyList_GET_ITEM(c->values, (Py_ssize_t)r);
+        Py_INCREF(v);
+        return v;
+    }
+    if (c->kind == COLUMN_INTS) {
+        return PyLong_FromLongLong(c->packed[r].i);
+    }
+    double d = c->packed[r].d;
+    double integral;
+    if (d > -(double)EXACT_DOUBLE_INT && d < (double)EXACT_DOUBLE_INT &&
+        modf(d, &integral) == 0.0) {
+        return PyLong_FromLongLong((long long)d);
+    }
+    return PyFloat_FromDouble(d);
+}
 
-        skip_whitespace(ref);
-        PyObject *v = parse_value(ref);
+static int column_to_objects(column *c) {
+    PyObject *values = PyList_New((Py_ssize_t)c->len);
+    if (!values) {
+        return -1;
+    }
+    for (size_t r = 0; r < c->len; r++) {
+        PyObject *v = column_get(c, r);
         if (!v) {
-            Py_DECREF(k);
-            Py_DECREF(d);
-            return NULL;
+            Py_DECREF(values);
+            return -1;
         }
-        if (PyDict_SetItem(d, k, v) < 0) {
-            Py_DECREF(k);
-            Py_DECREF(v);
-            Py_DECREF(d);
-            return NULL;
+        PyList_SET_ITEM(values, (Py_ssize_t)r, v);
+    }
+    PyMem_Free(c->packed);
+    c->packed = NULL;
+    c->len = c->cap = 0;
+    c->values = values;
+    c->kind = COLUMN_OBJECTS;
+    return 0;
+}
+
+/*
+ * column_to_floats:
+ * Widens an int column when a float arrives; fails (leaving it alone)
+ * if an int would not survive the round trip through double.
+ */
+static int column_to_floats(column *c) {
+    for (size_t r = 0; r < c->len; r++) {
+        if (c->packed[r].i <= -EXACT_DOUBLE_INT || c->packed[r].i >= EXACT_DOUBLE_INT) {
+            return -1;
         }
-        Py_DECREF(k);
+    }
+    for (size_t r = 0; r < c->len; r++) {
+        c->packed[r].d = (double)c->packed[r].i;
+    }
+    c->kind = COLUMN_FLOATS;
+    return 0;
+}
+
+static int column_add(column *c, PyObject *v) {
+    if (c->kind != COLUMN_OBJECTS && column_to_objects(c) < 0) {
         Py_DECREF(v);
+        return -1;
+    }
+    int rc = PyList_Append(c->values, v);
+    Py_DECREF(v);
+    return rc;
+}
 
-        skip_whitespace(ref);
-        if (**ref == '}') {
-            (*ref)++;
-            return d;
-        } else if (**ref == ',') {
-            (*ref)++;
-            skip_whitespace(ref);
-            if (**ref == '}') {
-                (*ref)++;
-                return d;
-            }
-        } else {
-            Py_DECREF(d);
-            RAISE("Expected '}' or ','");
+/*
+ * column_number:
+ * Appends a number token, packed if the column still allows it.
+ */
+static int column_number(column *c, const json5_token *tok) {
+    int is_float = (tok->flags & JSON5_FLOAT) != 0;
+    int pack;
+    if (is_float) {
+        pack = c->kind == COLUMN_FLOATS ||
+               (c->kind == COLUMN_INTS && column_to_floats(c) == 0);
+    } else if (c->kind == COLUMN_FLOATS) {
+        pack = tok->i > -EXACT_DOUBLE_INT && tok->i < EXACT_DOUBLE_INT;
+    } else {
+        pack = c->kind == COLUMN_INTS;
+    }
+    if (!pack) {
+        PyObject *v = is_float ? PyFloat_FromDouble(tok->d) : PyLong_FromLongLong(tok->i);
+        return v ? column_add(c, v) : -1;
+    }
+    if (c->len == c->cap) {
+        size_t cap = c->cap ? c->cap * 2 : 16;
+        packed_number *tmp = (packed_number*)PyMem_Realloc(c->packed, cap * sizeof(packed_number));
+        if (!tmp) {
+            PyErr_NoMemory();
+            return -1;
         }
+        c->packed = tmp;
+        c->cap = cap;
     }
-    Py_DECREF(d);
-    RAISE("Unterminated object");
+    if (c->kind == COLUMN_INTS) {
+        c->packed[c->len++].i = tok->i;
+    } else {
+        c->packed[c->len++].d = is_float ? tok->d : (double)tok->i;
+    }
+    return 0;
 }
 
 /*
- * parse_array:
- * Creates a PyList from JSON5 array syntax.
- * Simplified to use dynamic appending.
+ * column_finish:
+ * Returns the column's final value: its list, or an array.array of
+ * int64 ('q') or double ('d') for a packed one.
  */
-static PyObject* parse_array(const char **ref) {
-    PyObject *lst = PyList_New(0);
-    if (!lst) {
+static PyObject* column_finish(builder *b, column *c) {
+    if (c->kind == COLUMN_OBJECTS) {
+        PyObject *values = c->values;
+        c->values = NULL;
+        return values;
+    }
+    PyObject *raw = PyBytes_FromStringAndSize((const char*)c->packed,
+                                              (Py_ssize_t)(c->len * sizeof(packed_number)));
+    if (!raw) {
         return NULL;
     }
+    PyObject *arr = PyObject_CallFunction(b->array_type, "sO",
+                                          c->kind == COLUMN_INTS ? "q" : "d", raw);
+    Py_DECREF(raw);
+    return arr;
+}
 
-    while (1) {
-        skip_whitespace(ref);
-        if (**ref == ']') {
-            (*ref)++;
-            break;
+/*
+ * record_dict:
+ * Rebuilds the first nfields fields of record r as a dict.
+ */
+static PyObject* record_dict(const record_set *rs, size_t r, size_t nfields) {
+    PyObject *d = PyDict_New();
+    for (size_t j = 0; d && j < nfields; j++) {
+        PyObject *v = column_get(&rs->columns[j], r);
+        if (!v || PyDict_SetItem(d, rs->columns[j].name, v) < 0) {
+            Py_CLEAR(d);
         }
+        Py_XDECREF(v);
+    }
+    return d;
+}
 
-        PyObject *val = parse_value(ref);
-        if (!val) {
-            Py_DECREF(lst);
-            return NULL;
-        }
-        if (PyList_Append(lst, val) < 0) {
-            Py_DECREF(val);
-            Py_DECREF(lst);
-            return NULL;
+/*
+ * records_fallback:
+ * The array is not a record array after all: its finished records go
+ * into its list as dicts, and the record still open (if any) carries
+ * on as an ordinary dict frame holding the fields seen so far.
+ */
+static int records_fallback(build_frame *array, build_frame *open) {
+    record_set *rs = array->records;
+    int rc = 0;
+    for (size_t r = 0; rc == 0 && r < rs->records; r++) {
+        PyObject *d = record_dict(rs, r, rs->count);
+        rc = d ? PyList_Append(array->container, d) : -1;
+        Py_XDECREF(d);
+    }
+    if (open) {
+        open->records = NULL;
+        if (rc == 0) {
+            open->container = record_dict(rs, rs->records, rs->field);
+            rc = open->container ? 0 : -1;
         }
-        Py_DECREF(val);
+    }
+    records_free(rs);
+    array->records = NULL;
+    return rc;
+}
 
-        skip_whitespace(ref);
-        if (**ref == ',') {
-            (*ref)++;
-            // Allow trailing comma: if next is ']', finish parsing.
-            skip_whitespace(ref);
-            if (**ref == ']') {
-                (*ref)++;
-                break;
-            }
-        } else if (**ref == ']') {
-            (*ref)++;
-            break;
-        } else {
-            Py_DECREF(lst);
-            RAISE("Expected ']' or ','");
+/*
+ * records_open:
+ * Starts the next record of the array in the innermost frame.
+ */
+static int records_open(builder *b) {
+    record_set *rs = b->frames[b->depth - 1].records;
+    if (!rs) {
+        rs = (record_set*)PyMem_Calloc(1, sizeof(record_set));
+        if (!rs) {
+            PyErr_NoMemory();
+            return -1;
         }
+        b->frames[b->depth - 1].records = rs;
+    }
+    build_frame *f = build_push(b);
+    if (!f) {
+        return -1;
     }
-    return lst;
+    f->records = rs;
+    return 0;
 }
 
 /*
- * parse_string:
- * Consumes a quoted string (single or double).
+ * records_key:
+ * Matches a key of the open record to the next column, or adds a
+ * column while the first record is read.
  */
-static PyObject* parse_string(const char **ref) {
-    char quote_char = **ref;
-    (*ref)++;
-
-    size_t capacity = 64;
-    size_t length = 0;
-    char *buf = (char*)malloc(capacity);
-    if (!buf) {
-        RAISE("Out of memory");
-    }
-
-    while (**ref) {
-        char c = **ref;
-        if (c == quote_char) {
-            (*ref)++;
-            buf[length] = '\0';
-            PyObject *res = PyUnicode_FromStringAndSize(buf, (Py_ssize_t)length);
-            free(buf);
-            return res;
-        }
-        if (c == '\\') {
-            (*ref)++;
-            c = **ref;
-            // Skip line continuation if backslash is immediately followed by a newline.
-            if (c == '\n' || c == '\r') {
-                if (c == '\r' && (*ref)[1] == '\n') {
-                    (*ref)++;
-                }
-                (*ref)++;
-                continue;
+static int records_key(builder *b, build_frame *f, const json5_token *tok) {
+    record_set *rs = f->records;
+    PyObject *k = NULL;
+    if (rs->complete) {
+        if (rs->field < rs->count) {
+            column *c = &rs->columns[rs->field];
+            if (c->span_len == tok->len && memcmp(c->span, tok->ptr, tok->len) == 0) {
+                rs->field++;
+                return 0;
             }
-            switch (c) {
-                case 'n':  buf[length++] = '\n'; break;
-                case 't':  buf[length++] = '\t'; break;
-                case 'r':  buf[length++] = '\r'; break;
-                case 'b':  buf[length++] = '\b'; break;
-                case 'f':  buf[length++] = '\f'; break;
-                case '\\': buf[length++] = '\\'; break;
-                case '"':  buf[length++] = '"';  break;
-                case '\'': buf[length++] = '\''; break;
-                default:   buf[length++] = c;    break;
+            // Same key written differently, e.g. quoted vs. escaped.
+            k = make_string(tok);
+            if (!k) {
+                return -1;
             }
-            (*ref)++;
-        } else {
-            buf[length++] = c;
-            (*ref)++;
-        }
-        if (length + 1 >= capacity) {
-            capacity <<= 1;
-            char *tmp = (char*)realloc(buf, capacity);
-            if (!tmp) {
-                free(buf);
-                RAISE("Out of memory");
+            if (PyUnicode_Compare(k, c->name) == 0) {
+                Py_DECREF(k);
+                rs->field++;
+                return 0;
+            }
+        }
+    } else {
+        k = make_string(tok);
+        if (!k) {
+            return -1;
+        }
+        size_t j = 0;
+        while (j < rs->count && PyUnicode_Compare(k, rs->columns[j].name) != 0) {
+            j++;
+        }
+        if (j == rs->count) {
+            if (rs->count == rs->capacity) {
+                size_t capacity = rs->capacity ? rs->capacity * 2 : 8;
+                column *tmp = (column*)PyMem_Realloc(rs->columns, capacity * sizeof(column));
+                if (!tmp) {
+                    Py_DECREF(k);
+                    PyErr_NoMemory();
+                    return -1;
+                }
+                rs->columns = tmp;
+                rs->capacity = capacity;
             }
-            buf = tmp;
+            column *c = &rs->columns[rs->count++];
+            memset(c, 0, sizeof(column));
+            c->name = k;
+            c->span = tok->ptr;
+            c->span_len = tok->len;
+            if (b->columnar == COLUMNAR_PACKED) {
+                c->kind = COLUMN_INTS;
+            } else {
+                c->kind = COLUMN_OBJECTS;
+                c->values = PyList_New(0);
+                if (!c->values) {
+                    return -1;
+                }
+            }
+            rs->field++;
+            return 0;
         }
     }
-    free(buf);
-    RAISE("Unterminated string");
+    if (!k && !(k = make_string(tok))) {
+        return -1;
+    }
+    if (records_fallback(f - 1, f) < 0) {
+        Py_DECREF(k);
+        return -1;
+    }
+    f->key = k;
+    return 0;
 }
 
 /*
- * parse_number:
- * Tries to parse an integer or floating value from the input.
+ * records_add:
+ * build_add for record frames: a field value goes to its column, while
+ * anything but an object as an array element ends columnar collection.
  */
-static INLINE PyObject* parse_number(const char **ref) {
-    return fastNum(*ref, ref);
+static int records_add(build_frame *f, PyObject *v) {
+    if (!f->container) {
+        return column_add(&f->records->columns[f->records->field - 1], v);
+    }
+    if (records_fallback(f, NULL) < 0) {
+        Py_DECREF(v);
+        return -1;
+    }
+    int rc = PyList_Append(f->container, v);
+    Py_DECREF(v);
+    return rc;
 }
 
 /*
- * parse_true, parse_false, parse_null
+ * records_close:
+ * Ends a record, or a record array, which becomes a dict of columns.
  */
-static INLINE PyObject* parse_true(const char **ref) {
-    (*ref) += 4;
-    Py_RETURN_TRUE;
+static int records_close(builder *b) {
+    build_frame *f = &b->frames[b->depth - 1];
+    record_set *rs = f->records;
+    if (!f->container) {
+        if (rs->field == rs->count && rs->count > 0) {
+            rs->records++;
+            rs->field = 0;
+            rs->complete = 1;
+            b->depth--;
+            return 0;
+        }
+        if (records_fallback(f - 1, f) < 0) {
+            return -1;
+        }
+        return build_close(b);
+    }
+    PyObject *columns = PyDict_New();
+    for (size_t j = 0; columns && j < rs->count; j++) {
+        PyObject *v = column_finish(b, &rs->columns[j]);
+        if (!v || PyDict_SetItem(columns, rs->columns[j].name, v) < 0) {
+            Py_CLEAR(columns);
+        }
+        Py_XDECREF(v);
+    }
+    if (!columns) {
+        return -1;
+    }
+    records_free(rs);
+    f->records = NULL;
+    Py_SETREF(f->container, columns);
+    return build_close(b);
 }
 
-static INLINE PyObject* parse_false(const char **ref) {
-    (*ref) += 5;
-    Py_RETURN_FALSE;
+static int on_start_object(void *ctx) {
+    builder *b = (builder*)ctx;
+    if (b->columnar && b->depth > 0) {
+        build_frame *f = &b->frames[b->depth - 1];
+        // A record array in progress, or the first element of any array.
+        if (f->records ? f->container != NULL
+                       : (f->container && PyList_CheckExact(f->container) &&
+                          PyList_GET_SIZE(f->container) == 0)) {
+            return records_open(b);
+        }
+    }
+    return build_open(b, PyDict_New());
 }
 
-static INLINE PyObject* parse_null(const char **ref) {
-    (*ref) += 4;
-    Py_RETURN_NONE;
+static int on_start_array(void *ctx) {
+    return build_open((builder*)ctx, PyList_New(0));
 }
 
-/*
- * fastNum:
- * Helper for parse_number; returns PyLong or PyFloat.
- */
-static PyObject* fastNum(const char *start, const char **end) {
-    const char *p = start;
-    int sign = 1;
-    if (*p == '-') {
-        sign = -1;
-        p++;
-    } else if (*p == '+') {
-        p++;
-    }
-
-    // Check for hexadecimal literal: e.g. 0xdecaf
-    if (*p == '0' && (p[1] == 'x' || p[1] == 'X')) {
-        p += 2;
-        unsigned long long hexVal = 0;
-        int hasHex = 0;
-        while (isxdigit((unsigned char)*p)) {
-            hasHex = 1;
-            int digit = 0;
-            if (*p >= '0' && *p <= '9')
-                digit = *p - '0';
-            else if (*p >= 'a' && *p <= 'f')
-                digit = *p - 'a' + 10;
-            else if (*p >= 'A' && *p <= 'F')
-                digit = *p - 'A' + 10;
-            hexVal = hexVal * 16 + digit;
-            p++;
-        }
-        if (!hasHex) {
-            PyErr_SetString(PyExc_ValueError, "Invalid hexadecimal number");
-            return NULL;
-        }
-        *end = p;
-        if (sign < 0) {
-            if (hexVal <= 0x8000000000000000ULL)
-                return PyLong_FromLongLong(-(long long)hexVal);
-            else
-                return PyFloat_FromDouble(-(double)hexVal);
-        } else {
-            if (hexVal <= 0x7FFFFFFFFFFFFFFFULL)
-                return PyLong_FromLongLong((long long)hexVal);
-            else
-                return PyFloat_FromDouble((double)hexVal);
-        }
+static int on_end(void *ctx) {
+    builder *b = (builder*)ctx;
+    if (b->frames[b->depth - 1].records) {
+        return records_close(b);
     }
+    return build_close(b);
+}
 
-    int isFloat = 0;
-    double frac = 0.0;
-    double factor = 0.1;
-    int hasDig = 0;
-    long long iPart = 0;
-
-    // Support numbers starting with a dot (e.g. .8675309)
-    if (*p == '.') {
-        isFloat = 1;
-        p++;
-        while (*p >= '0' && *p <= '9') {
-            hasDig = 1;
-            frac += (*p - '0') * factor;
-            factor *= 0.1;
-            p++;
-        }
-    } else {
-        // Parse integer part
-        while (*p >= '0' && *p <= '9') {
-            hasDig = 1;
-            iPart = (iPart * 10) + (*p - '0');
-            p++;
-        }
-        // Check for decimal point (allow trailing dot)
-        if (*p == '.') {
-            isFloat = 1;
-            p++;
-            while (*p >= '0' && *p <= '9') {
-                hasDig = 1;
-                frac += (*p - '0') * factor;
-                factor *= 0.1;
-                p++;
-            }
-        }
+static int on_key(void *ctx, const json5_token *tok) {
+    builder *b = (builder*)ctx;
+    build_frame *f = &b->frames[b->depth - 1];
+    if (!f->container) {
+        return records_key(b, f, tok);
     }
-
-    int eSign = 1, eMode = 0;
-    long eVal = 0;
-    if (*p == 'e' || *p == 'E') {
-        isFloat = 1;
-        p++;
-        if (*p == '-') {
-            eSign = -1;
-            p++;
-        } else if (*p == '+') {
-            p++;
-        }
-        eMode = 1;
-        while (*p >= '0' && *p <= '9') {
-            eVal = eVal * 10 + (*p - '0');
-            p++;
-        }
+    PyObject *k = make_string(tok);
+    if (!k) {
+        return -1;
     }
-    *end = p;
+    f->key = k;
+    return 0;
+}
 
-    if (!hasDig) {
-        PyErr_SetString(PyExc_ValueError, "Invalid number literal");
-        return NULL;
+static int on_string(void *ctx, const json5_token *tok) {
+    return build_add((builder*)ctx, make_string(tok));
+}
+
+static int on_number(void *ctx, const json5_token *tok) {
+    builder *b = (builder*)ctx;
+    if (b->columnar == COLUMNAR_PACKED && b->depth > 0 && !b->frames[b->depth - 1].container) {
+        record_set *rs = b->frames[b->depth - 1].records;
+        return column_number(&rs->columns[rs->field - 1], tok);
     }
-    if (!isFloat) {
-        if (sign < 0) {
-            iPart = -iPart;
-        }
-        if (iPart >= -9007199254740992LL && iPart <= 9007199254740992LL) {
-            return PyLong_FromLongLong(iPart);
-        } else {
-            double dbl = (double)iPart;
-            return PyFloat_FromDouble(dbl);
-        }
-    } else {
-        double dbl = (double)iPart + frac;
-        if (sign < 0) {
-            dbl = -dbl;
-        }
-        if (eMode && eVal != 0) {
-            double factorE = pow(10.0, eVal);
-            if (eSign < 0) {
-                dbl /= factorE;
-            } else {
-                dbl *= factorE;
-            }
-        }
-        double integralPart;
-        if (modf(dbl, &integralPart) == 0.0 &&
-            dbl >= -9007199254740992.0 &&
-            dbl <= 9007199254740992.0) {
-            long long i64 = (long long)dbl;
-            return PyLong_FromLongLong(i64);
-        } else {
-            return PyFloat_FromDouble(dbl);
-        }
+    if (tok->flags & JSON5_FLOAT) {
+        return build_add((builder*)ctx, PyFloat_FromDouble(tok->d));
     }
+    return build_add((builder*)ctx, PyLong_FromLongLong(tok->i));
+}
+
+static int on_boolean(void *ctx, int value) {
+    PyObject *v = value ? Py_True : Py_False;
+    Py_INCREF(v);
+    return build_add((builder*)ctx, v);
+}
+
+static int on_null(void *ctx) {
+    Py_INCREF(Py_None);
+    return build_add((builder*)ctx, Py_None);
 }
 
+static const json5_callbacks build_callbacks = {
+    on_start_object,
+    on_end,
+    on_start_array,
+    on_end,
+    on_key,
+    on_string,
+    on_number,
+    on_boolean,
+    on_null,
+};
+
 /*
  * Dumping functions: dump_value, dump_dict, dump_list
  * Convert Python objects to JSON5 text.
@@ -536,11 +652,10 @@ static INLINE void append_char(char **buf, size_t *used, size_t *cap, char c) {
     }
 }
 
-static INLINE void append_str(char **buf, size_t *used, size_t *cap, const char *s) {
+static INLINE void append_mem(char **buf, size_t *used, size_t *cap, const char *s, size_t n) {
     if (!*buf) {
         return;
     }
-    size_t n = strlen(s);
     grow(buf, used, cap, n);
     if (*buf) {
         memcpy((*buf) + (*used), s, n);
@@ -548,6 +663,10 @@ static INLINE void append_str(char **buf, size_t *used, size_t *cap, const char
     }
 }
 
+static INLINE void append_str(char **buf, size_t *used, size_t *cap, const char *s) {
+    append_mem(buf, used, cap, s, strlen(s));
+}
+
 static INLINE void append_indent(int indent, int level,
                                  char **buf, size_t *used, size_t *cap) {
     if (!*buf || indent <= 0) {
@@ -595,13 +714,23 @@ static void dump_value(PyObject *obj, int indent, int level,
         }
         Py_DECREF(tmp);
     } else if (PyUnicode_Check(obj)) {
-        const char *s = PyUnicode_AsUTF8(obj);
+        Py_ssize_t size = 0;
+        const char *s = PyUnicode_AsUTF8AndSize(obj, &size);
         if (!s) {
             return;
         }
+        const char *p = s;
+        const char *end = s + size;
         append_char(buffer, len, cap, '\"');
-        for (const char *p = s; *p; p++) {
-            unsigned char ch = (unsigned char)*p;
+        while (p < end) {
+            // Copy the run that needs no escaping in one go.
+            const char *run = p;
+            p = json5_simd.find_escape(p, end);
+            append_mem(buffer, len, cap, run, (size_t)(p - run));
+            if (p >= end) {
+                break;
+            }
+            unsigned char ch = (unsigned char)*p++;
             switch (ch) {
                 case '\"': append_str(buffer, len, cap, "\\\""); break;
                 case '\\': append_str(buffer, len, cap, "\\\\"); break;
@@ -657,12 +786,21 @@ static void dump_dict(PyObject *obj, int indent, int level,
     Py_ssize_t i = 0;
     PyObject *key, *val;
 
+    // PyDict_Next hands out borrowed references, and dumping a key or
+    // value can run arbitrary code (str() of a key, or a nested critical
+    // section that suspends this one) that changes the dict, so both are
+    // held for as long as they are used.
+    Py_BEGIN_CRITICAL_SECTION(obj);
     while (PyDict_Next(obj, &pos, &key, &val)) {
         i++;
+        Py_INCREF(key);
+        Py_INCREF(val);
         append_indent(indent, level + 1, buffer, len, cap);
         dump_value(key, indent, level + 1, buffer, len, cap);
         append_str(buffer, len, cap, ": ");
         dump_value(val, indent, level + 1, buffer, len, cap);
+        Py_DECREF(key);
+        Py_DECREF(val);
         if (i < dsize) {
             append_char(buffer, len, cap, ',');
             if (indent == 0) {
@@ -673,9 +811,13 @@ static void dump_dict(PyObject *obj, int indent, int level,
             append_char(buffer, len, cap, '\n');
         }
         if (!*buffer) {
-            return;
+            break;
         }
     }
+    Py_END_CRITICAL_SECTION();
+    if (!*buffer) {
+        return;
+    }
     append_indent(indent, level, buffer, len, cap);
     append_char(buffer, len, cap, '}');
 }
@@ -697,13 +839,25 @@ static void dump_list(PyObject *obj, int indent, int level,
     if (indent > 0) {
         append_char(buffer, len, cap, '\n');
     }
+    // Lists are locked against other threads and re-measured each step,
+    // since dumping an item may run code that resizes the list.
+    Py_BEGIN_CRITICAL_SECTION(obj);
     for (Py_ssize_t i = 0; i < sz; i++) {
         PyObject *item = NULL;
         if (isList) {
+            sz = PyList_GET_SIZE(obj);
+            if (i >= sz) {
+                break;
+            }
             item = PyList_GET_ITEM(obj, i);
             Py_INCREF(item);
         } else {
             item = PySequence_GetItem(obj, i);
+            if (!item) {
+                free(*buffer);
+                *buffer = NULL;
+                break;
+            }
         }
         append_indent(indent, level + 1, buffer, len, cap);
         dump_value(item, indent, level + 1, buffer, len, cap);
@@ -718,31 +872,408 @@ static void dump_list(PyObject *obj, int indent, int level,
             append_char(buffer, len, cap, '\n');
         }
         if (!*buffer) {
-            return;
+            break;
         }
     }
+    Py_END_CRITICAL_SECTION();
+    if (!*buffer) {
+        return;
+    }
     append_indent(indent, level, buffer, len, cap);
     append_char(buffer, len, cap, ']');
 }
 
-PyObject* parse_json5(const char *input) {
+PyObject* parse_json5(const char *input, size_t length, int columnar, json5_error *err) {
     if (!input) {
         PyErr_SetString(PyExc_ValueError, "No input data");
         return NULL;
     }
-    const char *ptr = input;
-    skip_whitespace(&ptr);
-    PyObject *val = parse_value(&ptr);
-    if (!val) {
+    builder b;
+    builder_init(&b);
+    b.columnar = columnar;
+    if (columnar == COLUMNAR_PACKED) {
+        PyObject *mod = PyImport_ImportModule("array");
+        if (!mod) {
+            return NULL;
+        }
+        b.array_type = PyObject_GetAttrString(mod, "array");
+        Py_DECREF(mod);
+        if (!b.array_type) {
+            return NULL;
+        }
+    }
+    int rc = json5_parse(input, length, &build_callbacks, &b, err);
+    builder_free(&b);
+    if (rc != JSON5_OK) {
+        Py_XDECREF(b.result);
+        if (rc == JSON5_ERR_NOMEM) {
+            PyErr_NoMemory();
+        }
+        return NULL;
+    }
+    return b.result;
+}
+
+/*
+ * Streaming: a json5_callbacks consumer behind iterparse(). It tracks
+ * the dotted path of the current value ("" at the top, "key" inside an
+ * object, "item" inside an array) and either records (path, event,
+ * value) tuples or, given a prefix, hands each value found at that path
+ * to a builder and records the finished object.
+ */
+enum {
+    EV_START_MAP, EV_MAP_KEY, EV_END_MAP, EV_START_ARRAY, EV_END_ARRAY,
+    EV_STRING, EV_NUMBER, EV_BOOLEAN, EV_NULL, EV_COUNT
+};
+
+static const char *const event_names[EV_COUNT] = {
+    "start_map", "map_key", "end_map", "start_array", "end_array",
+    "string", "number", "boolean", "null",
+};
+
+typedef struct {
+    PyObject *path;
+    PyObject *item;     /* path of the elements for arrays, NULL for objects */
+} iter_frame;
+
+struct json5_iter {
+    json5_parser *parser;
+    PyObject *prefix;   /* NULL: report events */
+    PyObject *names[EV_COUNT];
+    PyObject *item_name;
+    PyObject *out;      /* results of the current feed */
+    PyObject *path;     /* path of the next value */
+    iter_frame *frames;
+    size_t depth;
+    size_t capacity;
+    builder b;          /* the value under prefix being built, if any */
+    int building;
+    char *pending;      /* input the last feed did not consume */
+    size_t pending_len;
+    size_t pending_cap;
+    size_t wait;        /* skip rescanning until this much is pending */
+};
+
+static INLINE PyObject* iter_join(PyObject *base, PyObject *name) {
+    if (PyUnicode_GET_LENGTH(base) == 0) {
+        Py_INCREF(name);
+        return name;
+    }
+    return PyUnicode_FromFormat("%U.%U", base, name);
+}
+
+/*
+ * iter_event:
+ * Records (path, event, value), stealing value (NULL means None).
+ */
+static int iter_event(json5_iter *it, PyObject *path, int event, PyObject *value) {
+    if (!value) {
+        value = Py_None;
+        Py_INCREF(value);
+    }
+    PyObject *t = PyTuple_Pack(3, path, it->names[event], value);
+    Py_DECREF(value);
+    if (!t) {
+        return -1;
+    }
+    int rc = PyList_Append(it->out, t);
+    Py_DECREF(t);
+    return rc;
+}
+
+/*
+ * iter_selected:
+ * Under a prefix, whether the value about to start sits at it.
+ */
+static INLINE int iter_selected(json5_iter *it) {
+    return it->path == it->prefix || PyUnicode_Compare(it->path, it->prefix) == 0;
+}
+
+/*
+ * iter_finish_item:
+ * Moves a completed value from the builder to the results.
+ */
+static int iter_finish_item(json5_iter *it) {
+    PyObject *v = it->b.result;
+    it->b.result = NULL;
+    it->building = 0;
+    int rc = PyList_Append(it->out, v);
+    Py_DECREF(v);
+    return rc;
+}
+
+static int iter_open(json5_iter *it, int is_object) {
+    if (it->building || (it->prefix && iter_selected(it))) {
+        it->building = 1;
+        return build_open(&it->b, is_object ? PyDict_New() : PyList_New(0));
+    }
+    if (!it->prefix
+        && iter_event(it, it->path, is_object ? EV_START_MAP : EV_START_ARRAY, NULL) < 0) {
+        return -1;
+    }
+    if (it->depth == it->capacity) {
+        size_t capacity = it->capacity ? it->capacity * 2 : 16;
+        iter_frame *tmp = (iter_frame*)PyMem_Realloc(it->frames, capacity * sizeof(iter_frame));
+        if (!tmp) {
+            PyErr_NoMemory();
+            return -1;
+        }
+        it->frames = tmp;
+        it->capacity = capacity;
+    }
+    PyObject *item = NULL;
+    if (!is_object && !(item = iter_join(it->path, it->item_name))) {
+        return -1;
+    }
+    iter_frame *f = &it->frames[it->depth++];
+    f->path = it->path;
+    f->item = item;
+    it->path = item;
+    Py_XINCREF(item);
+    return 0;
+}
+
+static int iter_close(json5_iter *it, int is_object) {
+    if (it->building) {
+        if (build_close(&it->b) < 0) {
+            return -1;
+        }
+        return it->b.depth == 0 ? iter_finish_item(it) : 0;
+    }
+    iter_frame f = it->frames[--it->depth];
+    int rc = 0;
+    if (!it->prefix) {
+        rc = iter_event(it, f.path, is_object ? EV_END_MAP : EV_END_ARRAY, NULL);
+    }
+    Py_DECREF(f.path);
+    Py_XDECREF(f.item);
+    // Back in the parent: the next array element, or wait for a key.
+    Py_XDECREF(it->path);
+    it->path = NULL;
+    if (it->depth > 0) {
+        it->path = it->frames[it->depth - 1].item;
+        Py_XINCREF(it->path);
+    }
+    return rc;
+}
+
+static int iter_start_object(void *ctx) {
+    return iter_open((json5_iter*)ctx, 1);
+}
+
+static int iter_start_array(void *ctx) {
+    return iter_open((json5_iter*)ctx, 0);
+}
+
+static int iter_end_object(void *ctx) {
+    return iter_close((json5_iter*)ctx, 1);
+}
+
+static int iter_end_array(void *ctx) {
+    return iter_close((json5_iter*)ctx, 0);
+}
+
+static int iter_key(void *ctx, const json5_token *tok) {
+    json5_iter *it = (json5_iter*)ctx;
+    if (it->building) {
+        return on_key(&it->b, tok);
+    }
+    PyObject *k = make_string(tok);
+    if (!k) {
+        return -1;
+    }
+    PyObject *parent = it->frames[it->depth - 1].path;
+    if (!it->prefix) {
+        Py_INCREF(k);
+        if (iter_event(it, parent, EV_MAP_KEY, k) < 0) {
+            Py_DECREF(k);
+            return -1;
+        }
+    }
+    PyObject *path = iter_join(parent, k);
+    Py_DECREF(k);
+    if (!path) {
+        return -1;
+    }
+    Py_XSETREF(it->path, path);
+    return 0;
+}
+
+/*
+ * ITER_SCALAR:
+ * Adds a scalar to the value being built, records it as an event, or
+ * keeps it if it is selected by the prefix (skipping the conversion
+ * otherwise).
+ */
+#define ITER_SCALAR(ctx, event, make) do {                                 \
+    json5_iter *it_ = (json5_iter*)(ctx);                                  \
+    if (it_->building) {                                                   \
+        return build_add(&it_->b, (make));                                 \
+    }                                                                      \
+    if (!it_->prefix) {                                                    \
+        PyObject *v_ = (make);                                             \
+        return v_ ? iter_event(it_, it_->path, (event), v_) : -1;          \
+    }                                                                      \
+    if (!iter_selected(it_)) {                                             \
+        return 0;                                                          \
+    }                                                                      \
+    PyObject *v_ = (make);                                                 \
+    if (!v_) {                                                             \
+        return -1;                                                         \
+    }                                                                      \
+    int rc_ = PyList_Append(it_->out, v_);                                 \
+    Py_DECREF(v_);                                                         \
+    return rc_;                                                            \
+} while (0)
+
+static int iter_string(void *ctx, const json5_token *tok) {
+    ITER_SCALAR(ctx, EV_STRING, make_string(tok));
+}
+
+static int iter_number(void *ctx, const json5_token *tok) {
+    ITER_SCALAR(ctx, EV_NUMBER, (tok->flags & JSON5_FLOAT)
+                                ? PyFloat_FromDouble(tok->d)
+                                : PyLong_FromLongLong(tok->i));
+}
+
+static int iter_boolean(void *ctx, int value) {
+    ITER_SCALAR(ctx, EV_BOOLEAN, (Py_INCREF(value ? Py_True : Py_False),
+                                  value ? Py_True : Py_False));
+}
+
+static int iter_null(void *ctx) {
+    ITER_SCALAR(ctx, EV_NULL, (Py_INCREF(Py_None), Py_None));
+}
+
+#undef ITER_SCALAR
+
+static const json5_callbacks iter_callbacks = {
+    iter_start_object,
+    iter_end_object,
+    iter_start_array,
+    iter_end_array,
+    iter_key,
+    iter_string,
+    iter_number,
+    iter_boolean,
+    iter_null,
+};
+
+json5_iter* iter_new(PyObject *prefix) {
+    json5_iter *it = (json5_iter*)PyMem_Calloc(1, sizeof(json5_iter));
+    if (!it) {
+        PyErr_NoMemory();
+        return NULL;
+    }
+    builder_init(&it->b);
+    for (int i = 0; i < EV_COUNT; i++) {
+        if (!(it->names[i] = PyUnicode_InternFromString(event_names[i]))) {
+            iter_free(it);
+            return NULL;
+        }
+    }
+    it->item_name = PyUnicode_InternFromString("item");
+    it->path = PyUnicode_New(0, 0);
+    it->parser = json5_parser_new(&iter_callbacks, it);
+    if (!it->item_name || !it->path || !it->parser) {
+        if (!PyErr_Occurred()) {
+            PyErr_NoMemory();
+        }
+        iter_free(it);
+        return NULL;
+    }
+    Py_XINCREF(prefix);
+    it->prefix = prefix;
+    return it;
+}
+
+void iter_free(json5_iter *it) {
+    if (!it) {
+        return;
+    }
+    json5_parser_free(it->parser);
+    while (it->depth > 0) {
+        iter_frame *f = &it->frames[--it->depth];
+        Py_DECREF(f->path);
+        Py_XDECREF(f->item);
+    }
+    PyMem_Free(it->frames);
+    builder_free(&it->b);
+    Py_XDECREF(it->b.result);
+    for (int i = 0; i < EV_COUNT; i++) {
+        Py_XDECREF(it->names[i]);
+    }
+    Py_XDECREF(it->item_name);
+    Py_XDECREF(it->path);
+    Py_XDECREF(it->prefix);
+    PyMem_Free(it->pending);
+    PyMem_Free(it);
+}
+
+static int iter_keep(json5_iter *it, const char *data, size_t length) {
+    if (it->pending_len + length > it->pending_cap) {
+        size_t cap = it->pending_cap ? it->pending_cap : 4096;
+        while (cap < it->pending_len + length) {
+            cap *= 2;
+        }
+        char *tmp = (char*)PyMem_Realloc(it->pending, cap);
+        if (!tmp) {
+            PyErr_NoMemory();
+            return -1;
+        }
+        it->pending = tmp;
+        it->pending_cap = cap;
+    }
+    memcpy(it->pending + it->pending_len, data, length);
+    it->pending_len += length;
+    return 0;
+}
+
+PyObject* iter_feed(json5_iter *it, const char *data, size_t length, int final,
+                    json5_error *err) {
+    const char *input = data;
+    size_t input_len = length;
+    if (it->pending_len) {
+        if (iter_keep(it, data, length) < 0) {
+            return NULL;
+        }
+        input = it->pending;
+        input_len = it->pending_len;
+    }
+    PyObject *out = PyList_New(0);
+    if (!out) {
+        return NULL;
+    }
+    // A token longer than the blocks would otherwise be rescanned on
+    // every feed; wait until the pending input has doubled.
+    if (!final && input_len < it->wait) {
+        if (input == data && iter_keep(it, data, length) < 0) {
+            Py_DECREF(out);
+            return NULL;
+        }
+        return out;
+    }
+    it->out = out;
+    size_t used = 0;
+    int rc = json5_parser_feed(it->parser, input, input_len, final, &used, err);
+    it->out = NULL;
+    if (rc != JSON5_OK && rc != JSON5_NEED_MORE) {
+        Py_DECREF(out);
+        if (rc == JSON5_ERR_NOMEM) {
+            PyErr_NoMemory();
+        }
         return NULL;
     }
-    skip_whitespace(&ptr);
-    if (*ptr != '\0') {
-        Py_XDECREF(val);
-        PyErr_SetString(PyExc_ValueError, "Extra data after top-level value");
+    size_t rest = input_len - used;
+    if (input == it->pending) {
+        memmove(it->pending, it->pending + used, rest);
+        it->pending_len = rest;
+    } else if (rest && iter_keep(it, input + used, rest) < 0) {
+        Py_DECREF(out);
         return NULL;
     }
-    return val;
+    it->wait = rest * 2;
+    return out;
 }
 
 PyObject* dump_json5(PyObject *obj, int indent) {
@@ -2,18 +2,48 @@
 #define QJSON5_JSON5_H
 
 #include <Python.h>  /* We rely on Python objects here. */
+#include "json5_core.h"
+
+/* Critical sections arrived in 3.13; before that the GIL serializes access. */
+#ifndef Py_BEGIN_CRITICAL_SECTION
+#define Py_BEGIN_CRITICAL_SECTION(op) {
+#define Py_END_CRITICAL_SECTION() }
+#endif
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/* parse_json5 columnar modes */
+#define COLUMNAR_OFF    0
+#define COLUMNAR_LISTS  1   /* record arrays become dicts of lists */
+#define COLUMNAR_PACKED 2   /* ... with numeric columns as array.array */
+
 /*
  * parse_json5:
- *   Takes a const char* JSON5 text.
- *   Returns a PyObject* (the parsed Python object),
- *   or NULL on error (with a Python exception set).
+ *   Takes length bytes of JSON5 text.
+ *   Returns a PyObject* (the parsed Python object), or NULL on error:
+ *   a syntax error fills *err and leaves no exception set, anything
+ *   else sets a Python exception. Unless columnar is COLUMNAR_OFF,
+ *   arrays of objects that share their keys in the same order come
+ *   back as {key: column} dicts.
  */
-PyObject* parse_json5(const char *input);
+PyObject* parse_json5(const char *input, size_t length, int columnar, json5_error *err);
+
+/*
+ * json5_iter:
+ *   Incremental parser behind iterparse(). With prefix NULL each feed
+ *   returns a list of (path, event, value) tuples; with a prefix (str),
+ *   a list of the values found at that path. Input may be split
+ *   anywhere; unconsumed bytes are kept for the next feed, and final
+ *   marks the last one. NULL is returned as for parse_json5.
+ */
+typedef struct json5_iter json5_iter;
+
+json5_iter* iter_new(PyObject *prefix);
+PyObject* iter_feed(json5_iter *it, const char *data, size_t length, int final,
+                    json5_error *err);
+void iter_free(json5_iter *it);
 
 /*
  * dump_json5:
@@ -0,0 +1,1371 @@
+#include "json5_core.h"
+#include "simd.h"
+#include <string.h>
+#include <ctype.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+
+#if defined(_MSC_VER)
+#define INLINE __forceinline
+#elif defined(__GNUC__) || defined(__clang__)
+#define INLINE __attribute__((always_inline)) inline
+#else
+#define INLINE inline
+#endif
+
+#define IS_JS_IDENT_START(c) ((c) == '_' || (c) == '$' || isalpha((unsigned char)(c)))
+#define IS_JS_IDENT_PART(c)  ((c) == '_' || (c) == '$' || isalnum((unsigned char)(c)))
+
+#define STACK_INLINE_WORDS 16
+#define SCAN_PAD 16
+
+/*
+ * hex_value:
+ * Returns the value of a hex digit, or -1.
+ */
+static INLINE int hex_value(unsigned char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+/*
+ * read_hex:
+ * Reads exactly n hex digits; returns the value or -1.
+ */
+static INLINE long read_hex(const char *p, int n) {
+    long v = 0;
+    for (int i = 0; i < n; i++) {
+        int d = hex_value((unsigned char)p[i]);
+        if (d < 0) {
+            return -1;
+        }
+        v = (v << 4) | d;
+    }
+    return v;
+}
+
+/*
+ * read_utf8:
+ * Decodes one UTF-8 sequence whose lead byte is >= 0x80.
+ * Returns the number of bytes consumed, or 0 if malformed.
+ */
+static INLINE int read_utf8(const unsigned char *s, uint32_t *out) {
+    unsigned char c = s[0];
+    if (c >= 0xC2 && c <= 0xDF) {
+        if ((s[1] & 0xC0) != 0x80) return 0;
+        *out = ((uint32_t)(c & 0x1F) << 6) | (s[1] & 0x3F);
+        return 2;
+    }
+    if (c >= 0xE0 && c <= 0xEF) {
+        if ((s[1] & 0xC0) != 0x80 || (s[2] & 0xC0) != 0x80) return 0;
+        uint32_t cp = ((uint32_t)(c & 0x0F) << 12) | ((uint32_t)(s[1] & 0x3F) << 6) | (s[2] & 0x3F);
+        if (cp < 0x800 || (cp >= 0xD800 && cp <= 0xDFFF)) return 0;
+        *out = cp;
+        return 3;
+    }
+    if (c >= 0xF0 && c <= 0xF4) {
+        if ((s[1] & 0xC0) != 0x80 || (s[2] & 0xC0) != 0x80 || (s[3] & 0xC0) != 0x80) return 0;
+        uint32_t cp = ((uint32_t)(c & 0x07) << 18) | ((uint32_t)(s[1] & 0x3F) << 12)
+                    | ((uint32_t)(s[2] & 0x3F) << 6) | (s[3] & 0x3F);
+        if (cp < 0x10000 || cp > 0x10FFFF) return 0;
+        *out = cp;
+        return 4;
+    }
+    return 0;
+}
+
+/*
+ * read_escape:
+ * Decodes the escape sequence following a backslash at *ref.
+ * Returns 1 with the code point in *out, 0 for a line continuation,
+ * or -1 with *err set on a malformed escape.
+ * Looks ahead at most 11 bytes, and only past bytes that matched.
+ */
+static INLINE int read_escape(const char **ref, uint32_t *out, const char **err) {
+    const unsigned char *p = (const unsigned char*)*ref;
+    unsigned char c = *p;
+    switch (c) {
+        case 'n':  *out = '\n'; break;
+        case 't':  *out = '\t'; break;
+        case 'r':  *out = '\r'; break;
+        case 'b':  *out = '\b'; break;
+        case 'f':  *out = '\f'; break;
+        case 'v':  *out = '\v'; break;
+        case '0':  *out = 0;    break;
+        case '\r':
+            *ref += (p[1] == '\n') ? 2 : 1;
+            return 0;
+        case '\n':
+            *ref += 1;
+            return 0;
+        case 'x': {
+            long v = read_hex((const char*)p + 1, 2);
+            if (v < 0) {
+                *err = "Invalid \\x escape";
+                return -1;
+            }
+            *out = (uint32_t)v;
+            *ref += 3;
+            return 1;
+        }
+        case 'u': {
+            long v = read_hex((const char*)p + 1, 4);
+            if (v < 0) {
+                *err = "Invalid \\u escape";
+                return -1;
+            }
+            p += 5;
+            // Combine a high surrogate with a following \uDC00-\uDFFF escape.
+            if (v >= 0xD800 && v <= 0xDBFF && p[0] == '\\' && p[1] == 'u') {
+                long lo = read_hex((const char*)p + 2, 4);
+                if (lo >= 0xDC00 && lo <= 0xDFFF) {
+                    v = 0x10000 + ((v - 0xD800) << 10) + (lo - 0xDC00);
+                    p += 6;
+                }
+            }
+            *out = (uint32_t)v;
+            *ref = (const char*)p;
+            return 1;
+        }
+        case '\0':
+            *err = "Unterminated string";
+            return -1;
+        default:
+            if (c >= 0x80) {
+                int n = read_utf8(p, out);
+                if (!n) {
+                    *err = "Invalid UTF-8 in string";
+                    return -1;
+                }
+                *ref += n;
+                // U+2028 and U+2029 are line continuations like '\n'.
+                return (*out == 0x2028 || *out == 0x2029) ? 0 : 1;
+            }
+            *out = c;
+            break;
+    }
+    *ref += 1;
+    return 1;
+}
+
+/*
+ * Scanner: the JSON5 grammar driven by an explicit container stack
+ * instead of recursion, on a (pointer, length) span that need not be
+ * NUL-terminated.
+ */
+typedef struct {
+    uint64_t inline_bits[STACK_INLINE_WORDS];
+    uint64_t *bits;    /* bit set = object, clear = array */
+    size_t depth;
+    size_t capacity;   /* in levels */
+} scan_stack;
+
+/* Resume points of scan_document; each is saved once the events before it are sent. */
+enum {
+    SCAN_VALUE,        /* start of the document */
+    SCAN_OBJECT_OPEN,  /* after '{' or ',' in an object: key or '}' */
+    SCAN_ARRAY_OPEN,   /* after '[' or ',' in an array: value or ']' */
+    SCAN_COLON,
+    SCAN_CLOSE,        /* after a value */
+};
+
+typedef struct {
+    const char *start;
+    const char *end;
+    const char *pos;   /* position of the first error */
+    const char *msg;
+    int status;        /* JSON5_ERR_* once failed */
+    int final;         /* no input follows end */
+    int state;         /* SCAN_*: where the next run resumes */
+    const char *mark;  /* input consumed up to here */
+    scan_stack stack;
+    const json5_callbacks *cb;
+    void *ctx;
+} scanner;
+
+static void stack_init(scan_stack *s) {
+    s->bits = s->inline_bits;
+    s->depth = 0;
+    s->capacity = STACK_INLINE_WORDS * 64;
+}
+
+static void stack_free(scan_stack *s) {
+    if (s->bits != s->inline_bits) {
+        free(s->bits);
+    }
+}
+
+static INLINE int stack_push(scan_stack *s, int is_object) {
+    if (s->depth == s->capacity) {
+        size_t words = (s->capacity / 64) * 2;
+        uint64_t *tmp = (uint64_t*)malloc(words * sizeof(uint64_t));
+        if (!tmp) {
+            return -1;
+        }
+        memcpy(tmp, s->bits, (s->capacity / 64) * sizeof(uint64_t));
+        stack_free(s);
+        s->bits = tmp;
+        s->capacity = words * 64;
+    }
+    uint64_t mask = (uint64_t)1 << (s->depth & 63);
+    if (is_object) {
+        s->bits[s->depth >> 6] |= mask;
+    } else {
+        s->bits[s->depth >> 6] &= ~mask;
+    }
+    s->depth++;
+    return 0;
+}
+
+static INLINE int stack_top_is_object(const scan_stack *s) {
+    size_t i = s->depth - 1;
+    return (int)((s->bits[i >> 6] >> (i & 63)) & 1);
+}
+
+static INLINE const char* scan_fail(scanner *sc, const char *at, const char *msg) {
+    sc->pos = at;
+    sc->msg = msg;
+    sc->status = JSON5_ERR_SYNTAX;
+    return NULL;
+}
+
+/*
+ * scan_eof:
+ * Like scan_fail, for input that ends inside a value: more input could
+ * still make it valid.
+ */
+static INLINE const char* scan_eof(scanner *sc, const char *at, const char *msg) {
+    sc->pos = at;
+    sc->msg = msg;
+    sc->status = JSON5_ERR_TRUNCATED;
+    return NULL;
+}
+
+/*
+ * scan_whitespace:
+ * Advances over whitespace and comments.
+ */
+static INLINE const char* scan_whitespace(const char *p, const char *end) {
+    while (p < end) {
+        // NUL is not whitespace: it stops the scan as an unexpected token.
+        if ((unsigned char)*p <= ' ' && *p != '\0') {
+            // Single separators are common; only runs go to the kernel.
+            p++;
+            if (p < end && (unsigned char)*p <= ' ' && *p != '\0') {
+                p = json5_simd.skip_blanks(p, end);
+            }
+            continue;
+        }
+        if (*p != '/' || p + 1 >= end) {
+            break;
+        }
+        if (p[1] == '/') {
+            p += 2;
+            while (p < end && *p != '\n') {
+                p++;
+            }
+        } else if (p[1] == '*') {
+            p += 2;
+            while (p < end) {
+                if (p[0] == '*' && p + 1 < end && p[1] == '/') {
+                    p += 2;
+                    break;
+                }
+                p++;
+            }
+            if (p >= end) {
+                break;
+            }
+        } else {
+            break;
+        }
+    }
+    return p < end ? p : end;
+}
+
+/*
+ * scan_escape:
+ * Validates the escape sequence after a backslash at p, reusing
+ * read_escape. Near the end of the span the remaining bytes are copied
+ * into a NUL-padded buffer so read_escape never reads past it.
+ * *r is read_escape's result (1 = character, 0 = line continuation).
+ */
+static INLINE const char* scan_escape(scanner *sc, const char *p, uint32_t *cp, int *r) {
+    const char *err = NULL;
+    const char *q = p;
+    if (sc->end - p >= SCAN_PAD) {
+        *r = read_escape(&q, cp, &err);
+        if (*r < 0) {
+            return scan_fail(sc, p - 1, err);
+        }
+        return q;
+    }
+    char tail[SCAN_PAD + 1];
+    size_t n = (size_t)(sc->end - p);
+    memcpy(tail, p, n);
+    memset(tail + n, 0, sizeof(tail) - n);
+    q = tail;
+    *r = read_escape(&q, cp, &err);
+    if (*r < 0 || (size_t)(q - tail) > n) {
+        return scan_fail(sc, p - 1, err ? err : "Unterminated string");
+    }
+    return p + (q - tail);
+}
+
+/*
+ * scan_utf8:
+ * Validates one multi-byte UTF-8 sequence at p.
+ */
+static INLINE const char* scan_utf8(scanner *sc, const char *p, uint32_t *cp) {
+    int n;
+    if (sc->end - p >= 4) {
+        n = read_utf8((const unsigned char*)p, cp);
+    } else {
+        unsigned char tail[4] = {0, 0, 0, 0};
+        memcpy(tail, p, (size_t)(sc->end - p));
+        n = read_utf8(tail, cp);
+    }
+    if (!n) {
+        return scan_fail(sc, p, "Invalid UTF-8 in string");
+    }
+    return p + n;
+}
+
+/*
+ * scan_string:
+ * Validates a quoted string starting at its opening quote, measuring
+ * its decoded length and largest code point into *tok on the way.
+ */
+static INLINE const char* scan_string(scanner *sc, const char *p, json5_token *tok) {
+    const char *open = p;
+    char quote_char = *p++;
+    const char *end = sc->end;
+    size_t length = 0;
+    uint32_t maxchar = 0;
+    int flags = JSON5_QUOTED;
+    while (p < end) {
+        const char *run = p;
+        p = json5_simd.find_string_special(p, end, quote_char);
+        if (p != run) {
+            length += (size_t)(p - run);
+            if (maxchar < 0x7F) {
+                maxchar = 0x7F;
+            }
+        }
+        if (p >= end) {
+            break;
+        }
+        unsigned char c = (unsigned char)*p;
+        if (c == (unsigned char)quote_char) {
+            tok->ptr = open + 1;
+            tok->len = (size_t)(p - open - 1);
+            tok->length = length;
+            tok->max_char = maxchar;
+            tok->flags = flags;
+            return p + 1;
+        }
+        uint32_t cp;
+        int r = 1;
+        flags |= JSON5_ESCAPED;
+        if (c == '\\') {
+            p = scan_escape(sc, p + 1, &cp, &r);
+        } else {
+            p = scan_utf8(sc, p, &cp);
+        }
+        if (!p) {
+            // An escape or UTF-8 sequence cut off by the end of input.
+            if (end - sc->pos < SCAN_PAD
+                && !memchr(sc->pos, quote_char, (size_t)(end - sc->pos))) {
+                sc->status = JSON5_ERR_TRUNCATED;
+            }
+            return NULL;
+        }
+        if (r > 0) {
+            length++;
+            if (cp > maxchar) {
+                maxchar = cp;
+            }
+        }
+    }
+    return scan_eof(sc, open, "Unterminated string");
+}
+
+/*
+ * scan_number:
+ * Validates a number literal (optional sign, then hex digits after 0x, or
+ * digits with an optional '.' fraction and exponent). With convert set it
+ * also fills in tok's value in the same pass; callers pass a constant so
+ * validation gets a copy without the arithmetic.
+ */
+static INLINE const char* scan_number(scanner *sc, const char *p, json5_token *tok,
+                                      const int convert) {
+    const char *start = p;
+    const char *end = sc->end;
+    int hasDig = 0;
+    int sign = 1;
+    if (*p == '-') {
+        sign = -1;
+        p++;
+    } else if (*p == '+') {
+        p++;
+    }
+    tok->ptr = start;
+    tok->max_char = 0x7F;
+    tok->flags = 0;
+
+    // Check for hexadecimal literal: e.g. 0xdecaf
+    if (p + 1 < end && p[0] == '0' && (p[1] == 'x' || p[1] == 'X')) {
+        unsigned long long hexVal = 0;
+        int digit;
+        p += 2;
+        while (p < end && (digit = hex_value((unsigned char)*p)) >= 0) {
+            if (convert) {
+                hexVal = hexVal * 16 + (unsigned)digit;
+            }
+            hasDig = 1;
+            p++;
+        }
+        if (p >= end && !sc->final) {
+            return scan_eof(sc, start, "Invalid hexadecimal number");
+        }
+        if (!hasDig) {
+            return scan_fail(sc, start, "Invalid hexadecimal number");
+        }
+        tok->len = tok->length = (size_t)(p - start);
+        if (!convert) {
+            return p;
+        }
+        if (sign < 0 ? hexVal <= 0x8000000000000000ULL : hexVal <= 0x7FFFFFFFFFFFFFFFULL) {
+            tok->i = sign < 0 ? (long long)(0 - hexVal) : (long long)hexVal;
+        } else {
+            tok->d = sign < 0 ? -(double)hexVal : (double)hexVal;
+            tok->flags = JSON5_FLOAT;
+        }
+        return p;
+    }
+
+    int isFloat = 0;
+    double frac = 0.0;
+    double factor = 0.1;
+    long long iPart = 0;
+
+    // Integer part
+    while (p < end && *p >= '0' && *p <= '9') {
+        if (convert) {
+            iPart = (iPart * 10) + (*p - '0');
+        }
+        hasDig = 1;
+        p++;
+    }
+    // Decimal point, possibly leading (.5) or trailing (5.)
+    if (p < end && *p == '.') {
+        isFloat = 1;
+        p++;
+        while (p < end && *p >= '0' && *p <= '9') {
+            if (convert) {
+                frac += (*p - '0') * factor;
+                factor *= 0.1;
+            }
+            hasDig = 1;
+            p++;
+        }
+    }
+    int eSign = 1;
+    long eVal = 0;
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        isFloat = 1;
+        p++;
+        if (p < end && *p == '-') {
+            eSign = -1;
+            p++;
+        } else if (p < end && *p == '+') {
+            p++;
+        }
+        while (p < end && *p >= '0' && *p <= '9') {
+            if (convert) {
+                eVal = eVal * 10 + (*p - '0');
+            }
+            p++;
+        }
+    }
+    // The literal may continue in the next block.
+    if (p >= end && !sc->final) {
+        return scan_eof(sc, start, "Invalid number literal");
+    }
+    if (!hasDig) {
+        return scan_fail(sc, start, "Invalid number literal");
+    }
+    tok->len = tok->length = (size_t)(p - start);
+    if (!convert) {
+        return p;
+    }
+
+    if (!isFloat) {
+        if (sign < 0) {
+            iPart = -iPart;
+        }
+        if (iPart >= -9007199254740992LL && iPart <= 9007199254740992LL) {
+            tok->i = iPart;
+        } else {
+            tok->d = (double)iPart;
+            tok->flags = JSON5_FLOAT;
+        }
+        return p;
+    }
+    double dbl = (double)iPart + frac;
+    if (sign < 0) {
+        dbl = -dbl;
+    }
+    if (eVal != 0) {
+        double factorE = pow(10.0, eVal);
+        if (eSign < 0) {
+            dbl /= factorE;
+        } else {
+            dbl *= factorE;
+        }
+    }
+    double integralPart;
+    if (modf(dbl, &integralPart) == 0.0 &&
+        dbl >= -9007199254740992.0 &&
+        dbl <= 9007199254740992.0) {
+        tok->i = (long long)dbl;
+    } else {
+        tok->d = dbl;
+        tok->flags = JSON5_FLOAT;
+    }
+    return p;
+}
+
+/*
+ * scan_key:
+ * Validates an object key (quoted, or an unquoted identifier).
+ */
+static INLINE const char* scan_key(scanner *sc, const char *p, json5_token *tok) {
+    if (*p == '"' || *p == '\'') {
+        return scan_string(sc, p, tok);
+    }
+    const char *start = p;
+    const char *end = sc->end;
+    while (p < end && *p != ':' && (unsigned char)*p > ' '
+           && *p != ',' && *p != '}' && *p != '/') {
+        p++;
+    }
+    if (p >= end && !sc->final) {
+        return scan_eof(sc, start, "Unterminated object");
+    }
+    if (p == start) {
+        return scan_fail(sc, start, "Invalid key");
+    }
+    if (!IS_JS_IDENT_START((unsigned char)start[0])) {
+        return scan_fail(sc, start, "Invalid unquoted key start");
+    }
+    for (const char *q = start + 1; q < p; q++) {
+        if (!IS_JS_IDENT_PART((unsigned char)*q)) {
+            return scan_fail(sc, q, "Invalid unquoted key char");
+        }
+    }
+    tok->ptr = start;
+    tok->len = (size_t)(p - start);
+    tok->length = tok->len;
+    tok->max_char = 0x7F;
+    tok->flags = 0;
+    return p;
+}
+
+/*
+ * scan_literal:
+ * Matches true/false/null at p. Returns 1 on a match, 0 on a mismatch
+ * and -1 if the input ends partway through a match.
+ */
+static INLINE int scan_literal(const char *p, const char *end, const char *lit, size_t n) {
+    size_t avail = (size_t)(end - p);
+    if (avail >= n) {
+        return memcmp(p, lit, n) == 0;
+    }
+    return memcmp(p, lit, avail) == 0 ? -1 : 0;
+}
+
+/*
+ * scan_document:
+ * Walks one top-level value and checks that only whitespace follows,
+ * reporting each token to sc->cb. Starts at sc->state, so a run that
+ * stopped at the end of a block can be resumed on the next one.
+ * Returns 0 on success, -1 with sc->status/msg/pos set on failure;
+ * sc->state and sc->mark always describe the last resume point.
+ */
+#define EMIT(at, call) do {                                                \
+    if (cb->call) {                                                        \
+        sc->pos = (at);                                                    \
+        sc->msg = "Aborted by callback";                                   \
+        sc->status = JSON5_ERR_ABORTED;                                    \
+        goto fail;                                                         \
+    }                                                                      \
+} while (0)
+#define HAS(fn) (cb && cb->fn)
+#define SAVE(st_) (state = (st_), mark = p)
+// A lone '/' at the end of a block may open a comment.
+#define AT_END(q) ((q) >= end || (!final && (q) + 1 == end && *(q) == '/'))
+#define EOF_FAIL(q, msg) do { scan_eof(sc, (q), (msg)); goto fail; } while (0)
+
+static int scan_document(scanner *sc) {
+    const char *end = sc->end;
+    scan_stack *st = &sc->stack;
+    const json5_callbacks *cb = sc->cb;
+    void *ctx = sc->ctx;
+    const char *p = sc->start;
+    const char *at;
+    const int final = sc->final;
+    int state = sc->state;
+    const char *mark = p;
+    json5_token tok;
+    int m;
+
+    switch (state) {
+        case SCAN_OBJECT_OPEN: goto object_open;
+        case SCAN_ARRAY_OPEN:  goto array_open;
+        case SCAN_COLON:       goto colon;
+        case SCAN_CLOSE:       goto close;
+        default:               break;
+    }
+
+value:
+    p = scan_whitespace(p, end);
+    if (AT_END(p)) {
+        EOF_FAIL(p, "Unexpected token");
+    }
+value_token:
+    // No resume point of its own: resuming from the previous one
+    // re-reads the same separator and lands here again.
+    at = p;
+    switch (*p) {
+        case '{':
+            if (stack_push(st, 1) < 0) {
+                scan_fail(sc, p, "Out of memory");
+                sc->status = JSON5_ERR_NOMEM;
+                goto fail;
+            }
+            if (HAS(start_object)) EMIT(at, start_object(ctx));
+            p++;
+            goto object_open;
+        case '[':
+            if (stack_push(st, 0) < 0) {
+                scan_fail(sc, p, "Out of memory");
+                sc->status = JSON5_ERR_NOMEM;
+                goto fail;
+            }
+            if (HAS(start_array)) EMIT(at, start_array(ctx));
+            p++;
+            goto array_open;
+        case '"':
+        case '\'':
+            p = scan_string(sc, p, &tok);
+            if (p && HAS(string)) EMIT(at, string(ctx, &tok));
+            break;
+        case 't':
+            if ((m = scan_literal(p, end, "true", 4)) > 0) {
+                p += 4;
+                if (HAS(boolean)) EMIT(at, boolean(ctx, 1));
+            } else {
+                p = (m < 0 ? scan_eof : scan_fail)(sc, p, "Unexpected token");
+            }
+            break;
+        case 'f':
+            if ((m = scan_literal(p, end, "false", 5)) > 0) {
+                p += 5;
+                if (HAS(boolean)) EMIT(at, boolean(ctx, 0));
+            } else {
+                p = (m < 0 ? scan_eof : scan_fail)(sc, p, "Unexpected token");
+            }
+            break;
+        case 'n':
+            if ((m = scan_literal(p, end, "null", 4)) > 0) {
+                p += 4;
+                if (HAS(null)) EMIT(at, null(ctx));
+            } else {
+                p = (m < 0 ? scan_eof : scan_fail)(sc, p, "Unexpected token");
+            }
+            break;
+        default:
+            if (*p == '-' || *p == '+' || *p == '.' || (*p >= '0' && *p <= '9')) {
+                if (HAS(number)) {
+                    p = scan_number(sc, p, &tok, 1);
+                    if (p) EMIT(at, number(ctx, &tok));
+                } else {
+                    p = scan_number(sc, p, &tok, 0);
+                }
+            } else {
+                p = scan_fail(sc, p, "Unexpected token");
+            }
+            break;
+    }
+    if (!p) {
+        goto fail;
+    }
+
+close:
+    SAVE(SCAN_CLOSE);
+    p = scan_whitespace(p, end);
+    if (st->depth == 0) {
+        if (p != end) {
+            if (AT_END(p)) {
+                EOF_FAIL(p, "Extra data after top-level value");
+            }
+            scan_fail(sc, p, "Extra data after top-level value");
+            goto fail;
+        }
+        if (!final) {
+            EOF_FAIL(p, "Extra data after top-level value");
+        }
+        return 0;
+    }
+    if (stack_top_is_object(st)) {
+        if (AT_END(p)) {
+            EOF_FAIL(p, "Expected '}' or ','");
+        }
+        if (*p == '}') {
+            st->depth--;
+            if (HAS(end_object)) EMIT(p, end_object(ctx));
+            p++;
+            goto close;
+        }
+        if (*p != ',') {
+            scan_fail(sc, p, "Expected '}' or ','");
+            goto fail;
+        }
+        p++;
+        goto object_open;
+    }
+    if (AT_END(p)) {
+        EOF_FAIL(p, "Expected ']' or ','");
+    }
+    if (*p == ']') {
+        st->depth--;
+        if (HAS(end_array)) EMIT(p, end_array(ctx));
+        p++;
+        goto close;
+    }
+    if (*p != ',') {
+        scan_fail(sc, p, "Expected ']' or ','");
+        goto fail;
+    }
+    p++;
+
+array_open:
+    SAVE(SCAN_ARRAY_OPEN);
+    p = scan_whitespace(p, end);
+    if (AT_END(p)) {
+        EOF_FAIL(p, "Unexpected token");
+    }
+    if (*p == ']') {
+        st->depth--;
+        if (HAS(end_array)) EMIT(p, end_array(ctx));
+        p++;
+        goto close;
+    }
+    goto value_token;
+
+object_open:
+    SAVE(SCAN_OBJECT_OPEN);
+    p = scan_whitespace(p, end);
+    if (AT_END(p)) {
+        EOF_FAIL(p, "Unterminated object");
+    }
+    if (*p == '}') {
+        st->depth--;
+        if (HAS(end_object)) EMIT(p, end_object(ctx));
+        p++;
+        goto close;
+    }
+    at = p;
+    p = scan_key(sc, p, &tok);
+    if (!p) {
+        goto fail;
+    }
+    if (HAS(key)) EMIT(at, key(ctx, &tok));
+
+colon:
+    SAVE(SCAN_COLON);
+    p = scan_whitespace(p, end);
+    if (AT_END(p)) {
+        EOF_FAIL(p, "Missing colon");
+    }
+    if (*p != ':') {
+        scan_fail(sc, p, "Missing colon");
+        goto fail;
+    }
+    p++;
+    goto value;
+
+fail:
+    // Resume state only leaves registers when the run stops.
+    sc->state = state;
+    sc->mark = mark;
+    return -1;
+}
+
+#undef EMIT
+#undef HAS
+#undef SAVE
+#undef AT_END
+#undef EOF_FAIL
+
+/*
+ * advance_position:
+ * Moves a 1-based line and column (in characters) over n bytes.
+ */
+static void advance_position(const char *p, size_t n, size_t *line, size_t *column) {
+    const char *end = p + n;
+    const char *nl;
+    while ((nl = (const char*)memchr(p, '\n', (size_t)(end - p))) != NULL) {
+        (*line)++;
+        *column = 1;
+        p = nl + 1;
+    }
+    size_t chars = 0;
+    for (; p < end; p++) {
+        chars += ((unsigned char)*p & 0xC0) != 0x80;
+    }
+    *column += chars;
+}
+
+static void scanner_init(scanner *sc, const json5_callbacks *cb, void *ctx) {
+    sc->pos = NULL;
+    sc->msg = NULL;
+    sc->status = JSON5_OK;
+    sc->state = SCAN_VALUE;
+    sc->cb = cb;
+    sc->ctx = ctx;
+    stack_init(&sc->stack);
+}
+
+/*
+ * scanner_run:
+ * Scans [input, input + length) from the saved resume point. Errors are
+ * reported relative to base, the position of input in the document.
+ */
+static int scanner_run(scanner *sc, const char *input, size_t length, int final,
+                       const json5_error *base, json5_error *err) {
+    sc->start = input;
+    sc->end = input + length;
+    sc->final = final;
+    sc->mark = input;
+    if (scan_document(sc) == 0) {
+        return JSON5_OK;
+    }
+    if (sc->status == JSON5_ERR_TRUNCATED && !final) {
+        return JSON5_NEED_MORE;
+    }
+    err->msg = sc->msg;
+    err->offset = base->offset + (size_t)(sc->pos - input);
+    err->line = base->line;
+    err->column = base->column;
+    advance_position(input, (size_t)(sc->pos - input), &err->line, &err->column);
+    return sc->status;
+}
+
+int json5_parse(const char *input, size_t length,
+                const json5_callbacks *cb, void *ctx, json5_error *err) {
+    static const json5_error origin = {NULL, 0, 1, 1};
+    scanner sc;
+    scanner_init(&sc, cb, ctx);
+    int rc = scanner_run(&sc, input, length, 1, &origin, err);
+    stack_free(&sc.stack);
+    return rc;
+}
+
+int json5_validate(const char *input, size_t length, json5_error *err) {
+    return json5_parse(input, length, NULL, NULL, err);
+}
+
+/*
+ * json5_parser: json5_parse split over blocks. The scanner keeps its
+ * container stack and resume point between feeds; pos tracks where the
+ * unconsumed input starts in the whole document.
+ */
+struct json5_parser {
+    scanner sc;
+    json5_error pos;
+    int status;
+};
+
+json5_parser* json5_parser_new(const json5_callbacks *cb, void *ctx) {
+    json5_parser *ps = (json5_parser*)malloc(sizeof(json5_parser));
+    if (!ps) {
+        return NULL;
+    }
+    scanner_init(&ps->sc, cb, ctx);
+    ps->pos.msg = NULL;
+    ps->pos.offset = 0;
+    ps->pos.line = 1;
+    ps->pos.column = 1;
+    ps->status = JSON5_NEED_MORE;
+    return ps;
+}
+
+int json5_parser_feed(json5_parser *ps, const char *input, size_t length, int final,
+                      size_t *consumed, json5_error *err) {
+    *consumed = 0;
+    if (ps->status != JSON5_NEED_MORE) {
+        *err = ps->pos;
+        err->msg = ps->status == JSON5_OK ? "Extra data after top-level value" : "Parser already failed";
+        return JSON5_ERR_SYNTAX;
+    }
+    int rc = scanner_run(&ps->sc, input, length, final, &ps->pos, err);
+    size_t n = rc == JSON5_NEED_MORE ? (size_t)(ps->sc.mark - input) : length;
+    if (rc >= 0) {
+        advance_position(input, n, &ps->pos.line, &ps->pos.column);
+        ps->pos.offset += n;
+        *consumed = n;
+    }
+    ps->status = rc;
+    return rc;
+}
+
+void json5_parser_free(json5_parser *ps) {
+    if (ps) {
+        stack_free(&ps->sc.stack);
+        free(ps);
+    }
+}
+
+/*
+ * DECODE_STRING:
+ * Writes the decoded code points of a validated token as TYPE units.
+ * Escapes were checked by the scanner and the closing quote follows the
+ * span, so read_escape's look-ahead stays inside the input.
+ */
+#define DECODE_STRING(TYPE, dst, tok) do {                                 \
+    TYPE *out_ = (TYPE*)(dst);                                             \
+    const char *p_ = (tok)->ptr;                                           \
+    const char *end_ = p_ + (tok)->len;                                    \
+    const char *err_ = NULL;                                               \
+    uint32_t cp_ = 0;                                                      \
+    while (p_ < end_) {                                                    \
+        const char *run_ = json5_simd.find_string_special(p_, end_, '\\'); \
+        if (sizeof(TYPE) == 1) {                                           \
+            memcpy(out_, p_, (size_t)(run_ - p_));                         \
+            out_ += run_ - p_;                                             \
+            p_ = run_;                                                     \
+        }                                                                  \
+        while (p_ < run_) {                                                \
+            *out_++ = (TYPE)(unsigned char)*p_++;                          \
+        }                                                                  \
+        if (p_ >= end_) {                                                  \
+            break;                                                         \
+        }                                                                  \
+        if (*p_ == '\\') {                                                 \
+            p_++;                                                          \
+            if (read_escape(&p_, &cp_, &err_) > 0) {                       \
+                *out_++ = (TYPE)cp_;                                       \
+            }                                                              \
+        } else {                                                           \
+            p_ += read_utf8((const unsigned char*)p_, &cp_);               \
+            *out_++ = (TYPE)cp_;                                           \
+        }                                                                  \
+    }                                                                      \
+} while (0)
+
+void json5_decode_string(const json5_token *tok, void *out, int width) {
+    if (!(tok->flags & JSON5_ESCAPED) && width == 1) {
+        memcpy(out, tok->ptr, tok->len);
+        return;
+    }
+    switch (width) {
+        case 1:  DECODE_STRING(uint8_t, out, tok);  break;
+        case 2:  DECODE_STRING(uint16_t, out, tok); break;
+        default: DECODE_STRING(uint32_t, out, tok); break;
+    }
+}
+
+/*
+ * Transcoding: a json5_callbacks consumer that re-emits each token into
+ * a malloc'd output buffer, formatted like the Python dumps(). Write
+ * errors are sticky (tc->nomem) and abort the parse.
+ */
+typedef struct {
+    char *buf;
+    size_t len;
+    size_t cap;
+    int indent;
+    int json5;        /* keep unquoted keys and number literals verbatim */
+    int first;        /* no item emitted yet in the innermost container */
+    int nomem;
+    scan_stack stack; /* container kinds, to place separators */
+} transcoder;
+
+static INLINE int tc_reserve(transcoder *tc, size_t need) {
+    if (tc->nomem) {
+        return -1;
+    }
+    if (tc->len + need > tc->cap) {
+        size_t cap = tc->cap;
+        while (tc->len + need > cap) {
+            cap <<= 1;
+        }
+        char *tmp = (char*)realloc(tc->buf, cap);
+        if (!tmp) {
+            tc->nomem = 1;
+            return -1;
+        }
+        tc->buf = tmp;
+        tc->cap = cap;
+    }
+    return 0;
+}
+
+static INLINE void tc_write(transcoder *tc, const char *s, size_t n) {
+    if (tc_reserve(tc, n) == 0) {
+        memcpy(tc->buf + tc->len, s, n);
+        tc->len += n;
+    }
+}
+
+static INLINE void tc_char(transcoder *tc, char c) {
+    if (tc_reserve(tc, 1) == 0) {
+        tc->buf[tc->len++] = c;
+    }
+}
+
+static INLINE void tc_newline(transcoder *tc, size_t depth) {
+    size_t total = (size_t)tc->indent * depth;
+    if (tc_reserve(tc, total + 1) == 0) {
+        tc->buf[tc->len++] = '\n';
+        memset(tc->buf + tc->len, ' ', total);
+        tc->len += total;
+    }
+}
+
+/*
+ * tc_item:
+ * Emits the separator in front of an array element or object member.
+ */
+static INLINE void tc_item(transcoder *tc) {
+    if (!tc->first) {
+        tc_char(tc, ',');
+        if (tc->indent <= 0) {
+            tc_char(tc, ' ');
+        }
+    }
+    tc->first = 0;
+    if (tc->indent > 0) {
+        tc_newline(tc, tc->stack.depth);
+    }
+}
+
+/*
+ * tc_value:
+ * Called before every value; array elements need a separator,
+ * object values already got theirs with the key.
+ */
+static INLINE void tc_value(transcoder *tc) {
+    if (tc->stack.depth > 0 && !stack_top_is_object(&tc->stack)) {
+        tc_item(tc);
+    }
+}
+
+static INLINE int tc_open(transcoder *tc, char c, int is_object) {
+    tc_value(tc);
+    if (stack_push(&tc->stack, is_object) < 0) {
+        tc->nomem = 1;
+    }
+    tc_char(tc, c);
+    tc->first = 1;
+    return tc->nomem;
+}
+
+static INLINE int tc_close(transcoder *tc, char c) {
+    tc->stack.depth--;
+    if (!tc->first && tc->indent > 0) {
+        tc_newline(tc, tc->stack.depth);
+    }
+    tc_char(tc, c);
+    tc->first = 0;
+    return tc->nomem;
+}
+
+/*
+ * tc_codepoint:
+ * Appends one decoded string character with JSON escaping.
+ */
+static void tc_codepoint(transcoder *tc, uint32_t cp) {
+    char esc[8];
+    switch (cp) {
+        case '\"': tc_write(tc, "\\\"", 2); return;
+        case '\\': tc_write(tc, "\\\\", 2); return;
+        case '\b': tc_write(tc, "\\b", 2);  return;
+        case '\f': tc_write(tc, "\\f", 2);  return;
+        case '\n': tc_write(tc, "\\n", 2);  return;
+        case '\r': tc_write(tc, "\\r", 2);  return;
+        case '\t': tc_write(tc, "\\t", 2);  return;
+        default:
+            break;
+    }
+    if (cp < 0x20 || (cp >= 0xD800 && cp <= 0xDFFF)) {
+        // Lone surrogates have no UTF-8 form; keep them as escapes.
+        snprintf(esc, sizeof(esc), "\\u%04x", (unsigned)cp);
+        tc_write(tc, esc, 6);
+    } else if (cp < 0x80) {
+        tc_char(tc, (char)cp);
+    } else if (cp < 0x800) {
+        esc[0] = (char)(0xC0 | (cp >> 6));
+        esc[1] = (char)(0x80 | (cp & 0x3F));
+        tc_write(tc, esc, 2);
+    } else if (cp < 0x10000) {
+        esc[0] = (char)(0xE0 | (cp >> 12));
+        esc[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        esc[2] = (char)(0x80 | (cp & 0x3F));
+        tc_write(tc, esc, 3);
+    } else {
+        esc[0] = (char)(0xF0 | (cp >> 18));
+        esc[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+        esc[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        esc[3] = (char)(0x80 | (cp & 0x3F));
+        tc_write(tc, esc, 4);
+    }
+}
+
+/*
+ * tc_string:
+ * Re-emits a string token as a double-quoted string. Runs of bytes
+ * that need no escaping are copied as-is.
+ */
+static void tc_string(transcoder *tc, const json5_token *tok) {
+    const char *p = tok->ptr;
+    const char *end = tok->ptr + tok->len;
+    tc_char(tc, '\"');
+    while (p < end) {
+        const char *run = p;
+        p = json5_simd.find_escape(p, end);
+        tc_write(tc, run, (size_t)(p - run));
+        if (p >= end) {
+            break;
+        }
+        uint32_t cp = (unsigned char)*p;
+        if (*p == '\\') {
+            const char *err = NULL;
+            p++;
+            if (read_escape(&p, &cp, &err) == 0) {
+                continue;
+            }
+        } else {
+            p++;
+        }
+        tc_codepoint(tc, cp);
+    }
+    tc_char(tc, '\"');
+}
+
+static int tc_start_object(void *ctx) {
+    return tc_open((transcoder*)ctx, '{', 1);
+}
+
+static int tc_end_object(void *ctx) {
+    return tc_close((transcoder*)ctx, '}');
+}
+
+static int tc_start_array(void *ctx) {
+    return tc_open((transcoder*)ctx, '[', 0);
+}
+
+static int tc_end_array(void *ctx) {
+    return tc_close((transcoder*)ctx, ']');
+}
+
+/*
+ * tc_key:
+ * Emits an object key; unquoted identifiers are quoted unless the
+ * target is JSON5.
+ */
+static int tc_key(void *ctx, const json5_token *tok) {
+    transcoder *tc = (transcoder*)ctx;
+    tc_item(tc);
+    if (tok->flags & JSON5_QUOTED) {
+        tc_string(tc, tok);
+    } else if (tc->json5) {
+        tc_write(tc, tok->ptr, tok->len);
+    } else {
+        tc_char(tc, '\"');
+        tc_write(tc, tok->ptr, tok->len);
+        tc_char(tc, '\"');
+    }
+    tc_write(tc, ": ", 2);
+    return tc->nomem;
+}
+
+static int tc_on_string(void *ctx, const json5_token *tok) {
+    transcoder *tc = (transcoder*)ctx;
+    tc_value(tc);
+    tc_string(tc, tok);
+    return tc->nomem;
+}
+
+/*
+ * tc_big_hex:
+ * Writes the hex digits [p, stop) in decimal when they do not fit in 64
+ * bits, converting through base-1e9 limbs so the value stays exact.
+ */
+static void tc_big_hex(transcoder *tc, const char *p, const char *stop) {
+    size_t cap = (size_t)(stop - p) / 7 + 2;  /* 16^n < 10^(9 * (n/7 + 1)) */
+    uint32_t *limbs = (uint32_t*)malloc(cap * sizeof(uint32_t));
+    if (!limbs) {
+        tc->nomem = 1;
+        return;
+    }
+    size_t count = 0;
+    for (; p < stop; p++) {
+        uint64_t carry = (uint64_t)hex_value((unsigned char)*p);
+        for (size_t i = 0; i < count; i++) {
+            uint64_t v = (uint64_t)limbs[i] * 16 + carry;
+            limbs[i] = (uint32_t)(v % 1000000000u);
+            carry = v / 1000000000u;
+        }
+        if (carry) {
+            limbs[count++] = (uint32_t)carry;
+        }
+    }
+    char digits[16];
+    int n = snprintf(digits, sizeof(digits), "%u", count ? limbs[count - 1] : 0u);
+    tc_write(tc, digits, (size_t)n);
+    for (size_t i = count > 0 ? count - 1 : 0; i-- > 0;) {
+        n = snprintf(digits, sizeof(digits), "%09u", limbs[i]);
+        tc_write(tc, digits, (size_t)n);
+    }
+    free(limbs);
+}
+
+/*
+ * tc_number:
+ * Rewrites a number literal as a JSON number: drops '+', converts hex
+ * to decimal, adds the leading zero of '.5', removes redundant leading
+ * zeros, a trailing '.' and an empty exponent.
+ */
+static int tc_number(void *ctx, const json5_token *tok) {
+    transcoder *tc = (transcoder*)ctx;
+    const char *p = tok->ptr;
+    const char *stop = tok->ptr + tok->len;
+    tc_value(tc);
+    if (tc->json5) {
+        tc_write(tc, tok->ptr, tok->len);
+        return tc->nomem;
+    }
+    if (*p == '+') {
+        p++;
+    } else if (*p == '-') {
+        tc_char(tc, '-');
+        p++;
+    }
+    if (stop - p > 1 && p[0] == '0' && (p[1] == 'x' || p[1] == 'X')) {
+        p += 2;
+        while (stop - p > 1 && *p == '0') {
+            p++;
+        }
+        if (stop - p > 16) {
+            tc_big_hex(tc, p, stop);
+            return tc->nomem;
+        }
+        unsigned long long hexVal = 0;
+        char digits[24];
+        for (; p < stop; p++) {
+            hexVal = hexVal * 16 + (unsigned)hex_value((unsigned char)*p);
+        }
+        int n = snprintf(digits, sizeof(digits), "%llu", hexVal);
+        tc_write(tc, digits, (size_t)n);
+        return tc->nomem;
+    }
+    const char *ip = p;
+    while (p < stop && *p >= '0' && *p <= '9') {
+        p++;
+    }
+    const char *ie = p;
+    while (ie - ip > 1 && *ip == '0') {
+        ip++;
+    }
+    if (ip == ie) {
+        tc_char(tc, '0');
+    } else {
+        tc_write(tc, ip, (size_t)(ie - ip));
+    }
+    if (p < stop && *p == '.') {
+        const char *fp = ++p;
+        while (p < stop && *p >= '0' && *p <= '9') {
+            p++;
+        }
+        if (p > fp) {
+            tc_char(tc, '.');
+            tc_write(tc, fp, (size_t)(p - fp));
+        }
+    }
+    if (p < stop) {
+        // Exponent: only emitted if it has digits.
+        const char *ep = p + 1;
+        if (ep < stop && (*ep == '+' || *ep == '-')) {
+            ep++;
+        }
+        if (ep < stop) {
+            tc_write(tc, p, (size_t)(stop - p));
+        }
+    }
+    return tc->nomem;
+}
+
+static int tc_boolean(void *ctx, int value) {
+    transcoder *tc = (transcoder*)ctx;
+    tc_value(tc);
+    if (value) {
+        tc_write(tc, "true", 4);
+    } else {
+        tc_write(tc, "false", 5);
+    }
+    return tc->nomem;
+}
+
+static int tc_null(void *ctx) {
+    transcoder *tc = (transcoder*)ctx;
+    tc_value(tc);
+    tc_write(tc, "null", 4);
+    return tc->nomem;
+}
+
+static const json5_callbacks transcode_callbacks = {
+    tc_start_object,
+    tc_end_object,
+    tc_start_array,
+    tc_end_array,
+    tc_key,
+    tc_on_string,
+    tc_number,
+    tc_boolean,
+    tc_null,
+};
+
+int json5_transcode(const char *input, size_t length, int indent, int json5_target,
+                    char **out, size_t *out_len, json5_error *err) {
+    transcoder tc;
+    tc.cap = length + 64;
+    tc.len = 0;
+    tc.indent = indent;
+    tc.json5 = json5_target;
+    tc.first = 1;
+    tc.nomem = 0;
+    stack_init(&tc.stack);
+    tc.buf = (char*)malloc(tc.cap);
+    if (!tc.buf) {
+        return JSON5_ERR_NOMEM;
+    }
+
+    int rc = json5_parse(input, length, &transcode_callbacks, &tc, err);
+    stack_free(&tc.stack);
+    if (rc == JSON5_ERR_ABORTED) {
+        rc = JSON5_ERR_NOMEM;
+    }
+    if (rc != JSON5_OK) {
+        free(tc.buf);
+        return rc;
+    }
+    *out = tc.buf;
+    *out_len = tc.len;
+    return JSON5_OK;
+}
@@ -0,0 +1,133 @@
+#ifndef QJSON5_JSON5_CORE_H
+#define QJSON5_JSON5_CORE_H
+
+/*
+ * Python-free JSON5 core: scanner, SAX-style event interface, string and
+ * number decoding helpers, and the JSON5 -> JSON transcoder. Build it on
+ * its own with `make` (libqjson5.a / libqjson5.so); the Python extension
+ * is one consumer of the same interface.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * json5_error:
+ *   Describes where parsing failed. offset is in bytes,
+ *   line and column are 1-based (column counts characters).
+ */
+typedef struct {
+    const char *msg;
+    size_t offset;
+    size_t line;
+    size_t column;
+} json5_error;
+
+#define JSON5_OK           0
+#define JSON5_ERR_SYNTAX  -1
+#define JSON5_ERR_NOMEM   -2
+#define JSON5_ERR_ABORTED -3   /* a callback returned non-zero */
+#define JSON5_ERR_TRUNCATED -4 /* input ended inside the document */
+#define JSON5_NEED_MORE    1   /* json5_parser_feed: document not finished yet */
+
+/* json5_token.flags */
+#define JSON5_QUOTED  1   /* string or quoted key (unset for identifier keys) */
+#define JSON5_ESCAPED 2   /* contains escapes or non-ASCII; decode before use */
+#define JSON5_FLOAT   4   /* number held in d rather than i */
+
+/*
+ * json5_token:
+ *   A key, string or number as it appears in the input. ptr points into
+ *   the caller's buffer and is only valid during the callback. For
+ *   strings and quoted keys it excludes the quotes. Numbers arrive
+ *   already converted: integers, hex and integral floats within +-2^53
+ *   in i, anything else in d with JSON5_FLOAT set.
+ */
+typedef struct {
+    const char *ptr;
+    size_t len;          /* in bytes */
+    size_t length;       /* strings/keys: decoded length in code points */
+    uint32_t max_char;   /* strings/keys: bound on the largest code point */
+    int flags;
+    long long i;         /* numbers: value unless JSON5_FLOAT */
+    double d;            /* numbers: value if JSON5_FLOAT */
+} json5_token;
+
+/*
+ * json5_callbacks:
+ *   Event handlers; any may be NULL. A non-zero return stops parsing
+ *   with JSON5_ERR_ABORTED.
+ */
+typedef struct {
+    int (*start_object)(void *ctx);
+    int (*end_object)(void *ctx);
+    int (*start_array)(void *ctx);
+    int (*end_array)(void *ctx);
+    int (*key)(void *ctx, const json5_token *tok);
+    int (*string)(void *ctx, const json5_token *tok);
+    int (*number)(void *ctx, const json5_token *tok);
+    int (*boolean)(void *ctx, int value);
+    int (*null)(void *ctx);
+} json5_callbacks;
+
+/*
+ * json5_parse:
+ *   Parses length bytes of JSON5 text (no NUL terminator needed),
+ *   reporting each token to cb. Does not allocate unless nesting is
+ *   deeper than 1024 levels. Returns JSON5_OK or an error code with
+ *   *err filled in; JSON5_ERR_TRUNCATED means the text stopped early
+ *   rather than being malformed.
+ */
+int json5_parse(const char *input, size_t length,
+                const json5_callbacks *cb, void *ctx, json5_error *err);
+
+/*
+ * json5_parser:
+ *   Incremental json5_parse for input that arrives in blocks. Each feed
+ *   reports the tokens it completes and sets *consumed; it returns
+ *   JSON5_NEED_MORE while the document is unfinished, and the caller
+ *   passes input[*consumed:] again at the front of the next feed (a token
+ *   cut by the end of a block is not consumed). The last feed sets final
+ *   and returns JSON5_OK or an error; error offsets, lines and columns
+ *   count from the start of the document. After an error the parser
+ *   only needs freeing.
+ */
+typedef struct json5_parser json5_parser;
+
+json5_parser* json5_parser_new(const json5_callbacks *cb, void *ctx);
+int json5_parser_feed(json5_parser *ps, const char *input, size_t length, int final,
+                      size_t *consumed, json5_error *err);
+void json5_parser_free(json5_parser *ps);
+
+/*
+ * json5_validate:
+ *   json5_parse without callbacks.
+ */
+int json5_validate(const char *input, size_t length, json5_error *err);
+
+/*
+ * json5_decode_string:
+ *   Writes the tok->length decoded code points of a string or key token
+ *   into out, as width-byte units (1, 2 or 4). width must be able to hold
+ *   tok->max_char.
+ */
+void json5_decode_string(const json5_token *tok, void *out, int width);
+
+/*
+ * json5_transcode:
+ *   Converts JSON5 text to JSON (json5_target = 0) or normalized JSON5
+ *   text-to-text. indent > 0 pretty-prints. On JSON5_OK, *out is a
+ *   malloc'd buffer the caller frees.
+ */
+int json5_transcode(const char *input, size_t length, int indent, int json5_target,
+                    char **out, size_t *out_len, json5_error *err);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
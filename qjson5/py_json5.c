@@ -1,22 +1,17 @@
 #define PY_SSIZE_T_CLEAN
 #include <Python.h>
+#include <string.h>
 #include "json5.h"
+#include "simd.h"
 
 /*
  * Python methods:
- *   loads(str) -> Python object
+ *   loads(data) -> Python object
  *   dumps(obj, indent=0) -> str
+ *   validate(data) -> None
+ *   transcode(data, indent=None, target="json") -> str
+ *   IterParser(prefix=None): feed(data) -> list, close() -> list
  */
-static PyObject* py_loads(PyObject* self, PyObject* args, PyObject* kwargs) {
-    static char *kwlist[] = {"data", NULL};
-    const char* input = NULL;
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s", kwlist, &input)) {
-        return NULL;
-    }
-    PyObject* result = parse_json5(input);
-    return result;  // parse_json5 sets exceptions on failure
-}
-
 static PyObject* py_dumps(PyObject* self, PyObject* args, PyObject* kwargs) {
     static char *kwlist[] = {"obj", "indent", NULL};
     PyObject* obj = NULL;
@@ -36,22 +31,410 @@ static PyObject* py_dumps(PyObject* self, PyObject* args, PyObject* kwargs) {
     return text;
 }
 
+/*
+ * module_state:
+ *   Objects owned by one instance of the module (multi-phase init), so
+ *   nothing mutable is shared between interpreters or kept in globals.
+ */
+typedef struct {
+    PyObject *decode_error;
+    PyTypeObject *iter_parser_type;
+} module_state;
+
+static inline module_state* get_state(PyObject *module) {
+    return (module_state*)PyModule_GetState(module);
+}
+
+/*
+ * raise_decode_error:
+ *   Raises JSON5DecodeError carrying msg, pos, lineno and colno.
+ */
+static void raise_decode_error(module_state *st, const json5_error *err) {
+    PyObject *text = PyUnicode_FromFormat("%s: line %zu column %zu (byte %zu)",
+                                          err->msg, err->line, err->column, err->offset);
+    if (!text) {
+        return;
+    }
+    PyObject *exc = PyObject_CallFunctionObjArgs(st->decode_error, text, NULL);
+    Py_DECREF(text);
+    if (!exc) {
+        return;
+    }
+    PyObject *msg = PyUnicode_FromString(err->msg);
+    PyObject *pos = PyLong_FromSize_t(err->offset);
+    PyObject *lineno = PyLong_FromSize_t(err->line);
+    PyObject *colno = PyLong_FromSize_t(err->column);
+    if (msg && pos && lineno && colno
+        && PyObject_SetAttrString(exc, "msg", msg) == 0
+        && PyObject_SetAttrString(exc, "pos", pos) == 0
+        && PyObject_SetAttrString(exc, "lineno", lineno) == 0
+        && PyObject_SetAttrString(exc, "colno", colno) == 0) {
+        PyErr_SetObject(st->decode_error, exc);
+    }
+    Py_XDECREF(msg);
+    Py_XDECREF(pos);
+    Py_XDECREF(lineno);
+    Py_XDECREF(colno);
+    Py_DECREF(exc);
+}
+
+/*
+ * text_input:
+ *   Borrows the UTF-8 bytes of a str, or the memory of any contiguous
+ *   buffer (bytes, bytearray, memoryview). Writable buffers are copied
+ *   first: another thread may change them mid-parse, and the scanner
+ *   relies on the bytes it validated staying put. Release with
+ *   text_release.
+ */
+typedef struct {
+    const char *data;
+    Py_ssize_t length;
+    Py_buffer view;
+    int has_view;
+    char *copy;
+} text_input;
+
+static int text_acquire(PyObject *obj, text_input *in) {
+    in->has_view = 0;
+    in->copy = NULL;
+    if (PyUnicode_Check(obj)) {
+        in->data = PyUnicode_AsUTF8AndSize(obj, &in->length);
+        return in->data ? 0 : -1;
+    }
+    if (PyObject_GetBuffer(obj, &in->view, PyBUF_SIMPLE) < 0) {
+        return -1;
+    }
+    in->length = in->view.len;
+    if (in->view.readonly) {
+        in->has_view = 1;
+        in->data = (const char*)in->view.buf;
+        return 0;
+    }
+    in->copy = (char*)PyMem_Malloc(in->length ? (size_t)in->length : 1);
+    if (in->copy) {
+        memcpy(in->copy, in->view.buf, (size_t)in->length);
+    }
+    PyBuffer_Release(&in->view);
+    if (!in->copy) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    in->data = in->copy;
+    return 0;
+}
+
+static void text_release(text_input *in) {
+    if (in->has_view) {
+        PyBuffer_Release(&in->view);
+    }
+    PyMem_Free(in->copy);
+}
+
+static PyObject* scan_failed(module_state *st, int rc, const json5_error *err) {
+    if (rc == JSON5_ERR_NOMEM) {
+        return PyErr_NoMemory();
+    }
+    raise_decode_error(st, err);
+    return NULL;
+}
+
+/*
+ * loads(data, columnar=False) -> Python object
+ *   Accepts str or any contiguous buffer. columnar=True turns record
+ *   arrays into dicts of column lists; "packed" also packs numeric
+ *   columns into array.array.
+ */
+static PyObject* py_loads(PyObject* self, PyObject* args, PyObject* kwargs) {
+    static char *kwlist[] = {"data", "columnar", NULL};
+    PyObject* data = NULL;
+    PyObject* columnar_obj = Py_False;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|O", kwlist, &data, &columnar_obj)) {
+        return NULL;
+    }
+    int columnar;
+    if (PyUnicode_Check(columnar_obj)) {
+        if (PyUnicode_CompareWithASCIIString(columnar_obj, "packed") != 0) {
+            PyErr_SetString(PyExc_ValueError, "columnar must be a bool or 'packed'");
+            return NULL;
+        }
+        columnar = COLUMNAR_PACKED;
+    } else {
+        int truth = PyObject_IsTrue(columnar_obj);
+        if (truth < 0) {
+            return NULL;
+        }
+        columnar = truth ? COLUMNAR_LISTS : COLUMNAR_OFF;
+    }
+    text_input in;
+    if (text_acquire(data, &in) < 0) {
+        return NULL;
+    }
+    json5_error err;
+    PyObject* result = parse_json5(in.data, (size_t)in.length, columnar, &err);
+    text_release(&in);
+    if (!result && !PyErr_Occurred()) {
+        raise_decode_error(get_state(self), &err);
+    }
+    return result;
+}
+
+/*
+ * validate(data) -> None
+ *   The scan runs with the GIL released.
+ */
+static PyObject* py_validate(PyObject* self, PyObject* args, PyObject* kwargs) {
+    static char *kwlist[] = {"data", NULL};
+    PyObject* data = NULL;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O", kwlist, &data)) {
+        return NULL;
+    }
+    text_input in;
+    if (text_acquire(data, &in) < 0) {
+        return NULL;
+    }
+
+    json5_error err;
+    int rc;
+    Py_BEGIN_ALLOW_THREADS
+    rc = json5_validate(in.data, (size_t)in.length, &err);
+    Py_END_ALLOW_THREADS
+
+    text_release(&in);
+    if (rc != JSON5_OK) {
+        return scan_failed(get_state(self), rc, &err);
+    }
+    Py_RETURN_NONE;
+}
+
+/*
+ * transcode(data, indent=None, target="json") -> str
+ *   Converts text-to-text with the GIL released; no Python objects
+ *   are built for the document itself.
+ */
+static PyObject* py_transcode(PyObject* self, PyObject* args, PyObject* kwargs) {
+    static char *kwlist[] = {"data", "indent", "target", NULL};
+    PyObject* data = NULL;
+    PyObject* indent_obj = Py_None;
+    const char* target = "json";
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|Os", kwlist,
+                                     &data, &indent_obj, &target)) {
+        return NULL;
+    }
+    int json5_target;
+    if (strcmp(target, "json") == 0) {
+        json5_target = 0;
+    } else if (strcmp(target, "json5") == 0) {
+        json5_target = 1;
+    } else {
+        PyErr_SetString(PyExc_ValueError, "target must be 'json' or 'json5'");
+        return NULL;
+    }
+    int indent_val = 0;
+    if (indent_obj != Py_None && PyLong_Check(indent_obj)) {
+        long tmp = PyLong_AsLong(indent_obj);
+        if (tmp < 0) tmp = 0;
+        indent_val = (int)tmp;
+    }
+    text_input in;
+    if (text_acquire(data, &in) < 0) {
+        return NULL;
+    }
+
+    json5_error err;
+    char *out = NULL;
+    size_t out_len = 0;
+    int rc;
+    Py_BEGIN_ALLOW_THREADS
+    rc = json5_transcode(in.data, (size_t)in.length, indent_val, json5_target,
+                         &out, &out_len, &err);
+    Py_END_ALLOW_THREADS
+
+    text_release(&in);
+    if (rc != JSON5_OK) {
+        return scan_failed(get_state(self), rc, &err);
+    }
+    PyObject *res = PyUnicode_DecodeUTF8(out, (Py_ssize_t)out_len, NULL);
+    free(out);
+    return res;
+}
+
+/*
+ * IterParser(prefix=None)
+ *   Incremental parser behind qjson5.iterparse(). feed(data) takes the
+ *   next block (str or bytes-like, split anywhere) and returns the events
+ *   or prefixed items it completed; close() ends the input and returns
+ *   the rest.
+ */
+typedef struct {
+    PyObject_HEAD
+    json5_iter *it;
+} IterParserObject;
+
+static PyObject* iter_parser_new(PyTypeObject *type, PyObject *args, PyObject *kwargs) {
+    static char *kwlist[] = {"prefix", NULL};
+    PyObject *prefix = Py_None;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|O", kwlist, &prefix)) {
+        return NULL;
+    }
+    if (prefix != Py_None && !PyUnicode_Check(prefix)) {
+        PyErr_SetString(PyExc_TypeError, "prefix must be a str or None");
+        return NULL;
+    }
+    IterParserObject *self = (IterParserObject*)type->tp_alloc(type, 0);
+    if (!self) {
+        return NULL;
+    }
+    self->it = iter_new(prefix == Py_None ? NULL : prefix);
+    if (!self->it) {
+        Py_DECREF(self);
+        return NULL;
+    }
+    return (PyObject*)self;
+}
+
+static void iter_parser_dealloc(IterParserObject *self) {
+    PyTypeObject *type = Py_TYPE(self);
+    iter_free(self->it);
+    type->tp_free((PyObject*)self);
+    Py_DECREF(type);
+}
+
+/*
+ * iter_parser_run:
+ *   Feeds one block. The critical section keeps two threads sharing a
+ *   parser from interleaving feeds (free-threaded builds; a no-op with
+ *   the GIL).
+ */
+static PyObject* iter_parser_run(IterParserObject *self, PyObject *data, int final) {
+    text_input in;
+    if (text_acquire(data, &in) < 0) {
+        return NULL;
+    }
+    json5_error err;
+    PyObject *res;
+    Py_BEGIN_CRITICAL_SECTION(self);
+    res = iter_feed(self->it, in.data, (size_t)in.length, final, &err);
+    Py_END_CRITICAL_SECTION();
+    text_release(&in);
+    if (!res && !PyErr_Occurred()) {
+        raise_decode_error((module_state*)PyType_GetModuleState(Py_TYPE(self)), &err);
+    }
+    return res;
+}
+
+static PyObject* iter_parser_feed(IterParserObject *self, PyObject *data) {
+    return iter_parser_run(self, data, 0);
+}
+
+static PyObject* iter_parser_close(IterParserObject *self, PyObject *unused) {
+    PyObject *empty = PyBytes_FromStringAndSize(NULL, 0);
+    if (!empty) {
+        return NULL;
+    }
+    PyObject *res = iter_parser_run(self, empty, 1);
+    Py_DECREF(empty);
+    return res;
+}
+
+static PyMethodDef iter_parser_methods[] = {
+    {"feed",  (PyCFunction)iter_parser_feed,  METH_O,
+     "Parse the next block of input; returns the completed events or items."},
+    {"close",  (PyCFunction)iter_parser_close,  METH_NOARGS,
+     "End the input; returns the remaining events or items."},
+    {NULL, NULL, 0, NULL}
+};
+
+static PyType_Slot iter_parser_slots[] = {
+    {Py_tp_new, (void*)iter_parser_new},
+    {Py_tp_dealloc, (void*)iter_parser_dealloc},
+    {Py_tp_methods, iter_parser_methods},
+    {Py_tp_doc, (void*)"Incremental JSON5 parser yielding events or items under a prefix."},
+    {0, NULL}
+};
+
+static PyType_Spec iter_parser_spec = {
+    "qjson5.py_json5.IterParser",
+    sizeof(IterParserObject),
+    0,
+    Py_TPFLAGS_DEFAULT,
+    iter_parser_slots,
+};
+
 static PyMethodDef py_json5_methods[] = {
     {"loads",  (PyCFunction)(void*)py_loads,  METH_VARARGS|METH_KEYWORDS,
      "Parse JSON5 string into Python object."},
     {"dumps",  (PyCFunction)(void*)py_dumps,  METH_VARARGS|METH_KEYWORDS,
      "Serialize Python object into JSON5 string."},
+    {"validate",  (PyCFunction)(void*)py_validate,  METH_VARARGS|METH_KEYWORDS,
+     "Check JSON5 text without building Python objects."},
+    {"transcode",  (PyCFunction)(void*)py_transcode,  METH_VARARGS|METH_KEYWORDS,
+     "Convert JSON5 text to JSON (or normalized JSON5) text."},
     {NULL, NULL, 0, NULL}
 };
 
+static int py_json5_exec(PyObject *m) {
+    module_state *st = get_state(m);
+    if (PyModule_AddStringConstant(m, "simd_level", json5_simd.name) < 0) {
+        return -1;
+    }
+    st->decode_error = PyErr_NewExceptionWithDoc(
+        "qjson5.JSON5DecodeError",
+        "Invalid JSON5 text; carries msg, pos (byte offset), lineno and colno.",
+        PyExc_ValueError, NULL);
+    if (!st->decode_error
+        || PyModule_AddObjectRef(m, "JSON5DecodeError", st->decode_error) < 0) {
+        return -1;
+    }
+    st->iter_parser_type = (PyTypeObject*)PyType_FromModuleAndSpec(m, &iter_parser_spec, NULL);
+    if (!st->iter_parser_type || PyModule_AddType(m, st->iter_parser_type) < 0) {
+        return -1;
+    }
+    return 0;
+}
+
+static int py_json5_traverse(PyObject *m, visitproc visit, void *arg) {
+    module_state *st = get_state(m);
+    Py_VISIT(st->decode_error);
+    Py_VISIT(st->iter_parser_type);
+    return 0;
+}
+
+static int py_json5_clear(PyObject *m) {
+    module_state *st = get_state(m);
+    Py_CLEAR(st->decode_error);
+    Py_CLEAR(st->iter_parser_type);
+    return 0;
+}
+
+static void py_json5_free(void *m) {
+    py_json5_clear((PyObject*)m);
+}
+
+static PyModuleDef_Slot py_json5_slots[] = {
+    {Py_mod_exec, (void*)py_json5_exec},
+#ifdef Py_mod_gil
+    // Nothing here relies on the GIL: no mutable globals, per-call buffers,
+    // and critical sections around shared containers and parsers.
+    {Py_mod_gil, Py_MOD_GIL_NOT_USED},
+#endif
+    {0, NULL}
+};
+
 static struct PyModuleDef py_json5_module = {
     PyModuleDef_HEAD_INIT,
     "py_json5",
     "Python <-> JSON5 Bridge",
-    -1,
-    py_json5_methods
+    sizeof(module_state),
+    py_json5_methods,
+    py_json5_slots,
+    py_json5_traverse,
+    py_json5_clear,
+    py_json5_free,
 };
 
 PyMODINIT_FUNC PyInit_py_json5(void) {
-    return PyModule_Create(&py_json5_module);
+#ifndef SIMD_AUTO_INIT
+    json5_simd_init();
+#endif
+    return PyModuleDef_Init(&py_json5_module);
 }
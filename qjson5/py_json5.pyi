@@ -1,9 +1,26 @@
-from typing import Any, Optional
+from typing import Any, List, Literal, Optional, Union
 
-def loads(data: str) -> Any:
+class JSON5DecodeError(ValueError):
     """
-    Parse a JSON5 string into a Python object.
-    Raises ValueError on invalid JSON5.
+    Raised for invalid JSON5. pos is the byte offset into the UTF-8 input;
+    lineno and colno are 1-based, with colno counting characters.
+    """
+
+    msg: str
+    pos: int
+    lineno: int
+    colno: int
+
+def loads(
+    data: Union[str, bytes, bytearray, memoryview],
+    columnar: Union[bool, Literal["packed"]] = False,
+) -> Any:
+    """
+    Parse JSON5 text (str or UTF-8 bytes) into a Python object.
+    With columnar=True, arrays of objects sharing the same keys in the same
+    order become {key: [values]}; "packed" also turns all-numeric columns
+    into array.array('q') or array.array('d').
+    Raises JSON5DecodeError on invalid JSON5.
     """
     ...
 
@@ -13,3 +30,42 @@ def dumps(obj: Any, indent: Optional[int] = None) -> str:
     Indent >= 1 => pretty-print.
     """
     ...
+
+def validate(data: Union[str, bytes, bytearray, memoryview]) -> None:
+    """
+    Check that 'data' is valid JSON5 without building Python objects.
+    Raises JSON5DecodeError with the byte offset, line and column on failure.
+    """
+    ...
+
+def transcode(
+    data: Union[str, bytes, bytearray, memoryview],
+    indent: Optional[int] = None,
+    target: Literal["json", "json5"] = "json",
+) -> str:
+    """
+    Convert JSON5 text to strict JSON (or normalized JSON5) text-to-text,
+    without building Python objects. Output is formatted like dumps().
+    Raises JSON5DecodeError on invalid JSON5.
+    """
+    ...
+
+class IterParser:
+    """
+    Incremental parser behind qjson5.iterparse(). Without a prefix it
+    produces (path, event, value) tuples; with one, the values at that path.
+    """
+
+    def __init__(self, prefix: Optional[str] = None) -> None: ...
+    def feed(self, data: Union[str, bytes, bytearray, memoryview]) -> List[Any]:
+        """
+        Parse the next block of input (split anywhere) and return the
+        events or items it completed.
+        """
+        ...
+    def close(self) -> List[Any]:
+        """
+        End the input and return the remaining events or items.
+        Raises JSON5DecodeError if the document is incomplete or invalid.
+        """
+        ...
@@ -0,0 +1,342 @@
+#include "simd.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SIMD_X86 1
+#include <immintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define CTZ(x) __builtin_ctz(x)
+#define CTZLL(x) __builtin_ctzll(x)
+#endif
+
+/*
+ * Scalar kernels: the fallback, and the tail loop of every vector kernel.
+ */
+static const char* skip_blanks_scalar(const char *p, const char *end) {
+    while (p < end && (unsigned char)*p <= ' ' && *p != '\0') {
+        p++;
+    }
+    return p;
+}
+
+static const char* find_string_special_scalar(const char *p, const char *end, char quote) {
+    while (p < end) {
+        unsigned char c = (unsigned char)*p;
+        if (c == (unsigned char)quote || c == '\\' || c >= 0x80) {
+            break;
+        }
+        p++;
+    }
+    return p;
+}
+
+static const char* find_escape_scalar(const char *p, const char *end) {
+    while (p < end) {
+        unsigned char c = (unsigned char)*p;
+        if (c < 0x20 || c == '"' || c == '\\') {
+            break;
+        }
+        p++;
+    }
+    return p;
+}
+
+#ifdef SIMD_X86
+
+/*
+ * SSE2 (baseline on x86-64). Unsigned "c <= k" is min_epu8(c, k) == c;
+ * non-ASCII bytes are picked up by movemask on the raw data. Blanks are
+ * 0x01..0x20 (NUL is not whitespace), tested as c - 1 <= 0x1F.
+ */
+__attribute__((target("sse2")))
+static const char* skip_blanks_sse2(const char *p, const char *end) {
+    const __m128i one = _mm_set1_epi8(1);
+    const __m128i sp = _mm_set1_epi8(' ' - 1);
+    for (; end - p >= 16; p += 16) {
+        __m128i v = _mm_sub_epi8(_mm_loadu_si128((const __m128i*)p), one);
+        int mask = ~_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(v, sp), v)) & 0xFFFF;
+        if (mask) {
+            return p + CTZ(mask);
+        }
+    }
+    return skip_blanks_scalar(p, end);
+}
+
+__attribute__((target("sse2")))
+static const char* find_string_special_sse2(const char *p, const char *end, char quote) {
+    const __m128i q = _mm_set1_epi8(quote);
+    const __m128i bs = _mm_set1_epi8('\\');
+    for (; end - p >= 16; p += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)p);
+        __m128i m = _mm_or_si128(_mm_cmpeq_epi8(v, q), _mm_cmpeq_epi8(v, bs));
+        int mask = _mm_movemask_epi8(_mm_or_si128(m, v));
+        if (mask) {
+            return p + CTZ(mask);
+        }
+    }
+    return find_string_special_scalar(p, end, quote);
+}
+
+__attribute__((target("sse2")))
+static const char* find_escape_sse2(const char *p, const char *end) {
+    const __m128i dq = _mm_set1_epi8('"');
+    const __m128i bs = _mm_set1_epi8('\\');
+    const __m128i ctl = _mm_set1_epi8(0x1F);
+    for (; end - p >= 16; p += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)p);
+        __m128i m = _mm_or_si128(_mm_cmpeq_epi8(v, dq), _mm_cmpeq_epi8(v, bs));
+        m = _mm_or_si128(m, _mm_cmpeq_epi8(_mm_min_epu8(v, ctl), v));
+        int mask = _mm_movemask_epi8(m);
+        if (mask) {
+            return p + CTZ(mask);
+        }
+    }
+    return find_escape_scalar(p, end);
+}
+
+__attribute__((target("avx2")))
+static const char* skip_blanks_avx2(const char *p, const char *end) {
+    const __m256i one = _mm256_set1_epi8(1);
+    const __m256i sp = _mm256_set1_epi8(' ' - 1);
+    for (; end - p >= 32; p += 32) {
+        __m256i v = _mm256_sub_epi8(_mm256_loadu_si256((const __m256i*)p), one);
+        unsigned mask = ~(unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_min_epu8(v, sp), v));
+        if (mask) {
+            return p + CTZ(mask);
+        }
+    }
+    return skip_blanks_sse2(p, end);
+}
+
+__attribute__((target("avx2")))
+static const char* find_string_special_avx2(const char *p, const char *end, char quote) {
+    const __m256i q = _mm256_set1_epi8(quote);
+    const __m256i bs = _mm256_set1_epi8('\\');
+    for (; end - p >= 32; p += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)p);
+        __m256i m = _mm256_or_si256(_mm256_cmpeq_epi8(v, q), _mm256_cmpeq_epi8(v, bs));
+        unsigned mask = (unsigned)_mm256_movemask_epi8(_mm256_or_si256(m, v));
+        if (mask) {
+            return p + CTZ(mask);
+        }
+    }
+    return find_string_special_sse2(p, end, quote);
+}
+
+__attribute__((target("avx2")))
+static const char* find_escape_avx2(const char *p, const char *end) {
+    const __m256i dq = _mm256_set1_epi8('"');
+    const __m256i bs = _mm256_set1_epi8('\\');
+    const __m256i ctl = _mm256_set1_epi8(0x1F);
+    for (; end - p >= 32; p += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)p);
+        __m256i m = _mm256_or_si256(_mm256_cmpeq_epi8(v, dq), _mm256_cmpeq_epi8(v, bs));
+        m = _mm256_or_si256(m, _mm256_cmpeq_epi8(_mm256_min_epu8(v, ctl), v));
+        unsigned mask = (unsigned)_mm256_movemask_epi8(m);
+        if (mask) {
+            return p + CTZ(mask);
+        }
+    }
+    return find_escape_sse2(p, end);
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static const char* skip_blanks_avx512(const char *p, const char *end) {
+    const __m512i one = _mm512_set1_epi8(1);
+    const __m512i sp = _mm512_set1_epi8(' ' - 1);
+    for (; end - p >= 64; p += 64) {
+        __m512i v = _mm512_sub_epi8(_mm512_loadu_si512((const void*)p), one);
+        unsigned long long mask = _mm512_cmpgt_epu8_mask(v, sp);
+        if (mask) {
+            return p + CTZLL(mask);
+        }
+    }
+    return skip_blanks_avx2(p, end);
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static const char* find_string_special_avx512(const char *p, const char *end, char quote) {
+    const __m512i q = _mm512_set1_epi8(quote);
+    const __m512i bs = _mm512_set1_epi8('\\');
+    for (; end - p >= 64; p += 64) {
+        __m512i v = _mm512_loadu_si512((const void*)p);
+        unsigned long long mask = _mm512_cmpeq_epi8_mask(v, q) | _mm512_cmpeq_epi8_mask(v, bs)
+                                | _mm512_movepi8_mask(v);
+        if (mask) {
+            return p + CTZLL(mask);
+        }
+    }
+    return find_string_special_avx2(p, end, quote);
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static const char* find_escape_avx512(const char *p, const char *end) {
+    const __m512i dq = _mm512_set1_epi8('"');
+    const __m512i bs = _mm512_set1_epi8('\\');
+    const __m512i ctl = _mm512_set1_epi8(0x1F);
+    for (; end - p >= 64; p += 64) {
+        __m512i v = _mm512_loadu_si512((const void*)p);
+        unsigned long long mask = _mm512_cmpeq_epi8_mask(v, dq) | _mm512_cmpeq_epi8_mask(v, bs)
+                                | _mm512_cmple_epu8_mask(v, ctl);
+        if (mask) {
+            return p + CTZLL(mask);
+        }
+    }
+    return find_escape_avx2(p, end);
+}
+
+#endif /* SIMD_X86 */
+
+#ifdef SIMD_NEON
+
+/*
+ * NEON is baseline on AArch64; a hit in a 16-byte block is located
+ * with the scalar kernel.
+ */
+static const char* skip_blanks_neon(const char *p, const char *end) {
+    const uint8x16_t one = vdupq_n_u8(1);
+    const uint8x16_t sp = vdupq_n_u8(' ' - 1);
+    for (; end - p >= 16; p += 16) {
+        uint8x16_t v = vsubq_u8(vld1q_u8((const uint8_t*)p), one);
+        if (vmaxvq_u8(vcgtq_u8(v, sp))) {
+            return skip_blanks_scalar(p, p + 16);
+        }
+    }
+    return skip_blanks_scalar(p, end);
+}
+
+static const char* find_string_special_neon(const char *p, const char *end, char quote) {
+    const uint8x16_t q = vdupq_n_u8((uint8_t)quote);
+    const uint8x16_t bs = vdupq_n_u8('\\');
+    const uint8x16_t hi = vdupq_n_u8(0x7F);
+    for (; end - p >= 16; p += 16) {
+        uint8x16_t v = vld1q_u8((const uint8_t*)p);
+        uint8x16_t m = vorrq_u8(vorrq_u8(vceqq_u8(v, q), vceqq_u8(v, bs)), vcgtq_u8(v, hi));
+        if (vmaxvq_u8(m)) {
+            return find_string_special_scalar(p, p + 16, quote);
+        }
+    }
+    return find_string_special_scalar(p, end, quote);
+}
+
+static const char* find_escape_neon(const char *p, const char *end) {
+    const uint8x16_t dq = vdupq_n_u8('"');
+    const uint8x16_t bs = vdupq_n_u8('\\');
+    const uint8x16_t ctl = vdupq_n_u8(0x1F);
+    for (; end - p >= 16; p += 16) {
+        uint8x16_t v = vld1q_u8((const uint8_t*)p);
+        uint8x16_t m = vorrq_u8(vorrq_u8(vceqq_u8(v, dq), vceqq_u8(v, bs)), vcleq_u8(v, ctl));
+        if (vmaxvq_u8(m)) {
+            return find_escape_scalar(p, p + 16);
+        }
+    }
+    return find_escape_scalar(p, end);
+}
+
+#endif /* SIMD_NEON */
+
+json5_simd_kernels json5_simd = {
+    skip_blanks_scalar,
+    find_string_special_scalar,
+    find_escape_scalar,
+    "scalar",
+};
+
+enum { LEVEL_SCALAR, LEVEL_SSE2, LEVEL_AVX2, LEVEL_AVX512, LEVEL_NEON };
+
+static int detect_level(void) {
+#if defined(SIMD_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512bw")) {
+        return LEVEL_AVX512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return LEVEL_AVX2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return LEVEL_SSE2;
+    }
+#elif defined(SIMD_NEON)
+    return LEVEL_NEON;
+#endif
+    return LEVEL_SCALAR;
+}
+
+static int requested_level(int detected) {
+    const char *env = getenv("QJSON5_SIMD");
+    if (!env || !*env) {
+        return detected;
+    }
+    // Anything unrecognized means the caller wanted to cap the level,
+    // so take the safe choice rather than ignoring it.
+    int want = LEVEL_SCALAR;
+    if (strcmp(env, "sse2") == 0) {
+        want = LEVEL_SSE2;
+    } else if (strcmp(env, "avx2") == 0) {
+        want = LEVEL_AVX2;
+    } else if (strcmp(env, "avx512") == 0) {
+        want = LEVEL_AVX512;
+    } else if (strcmp(env, "neon") == 0) {
+        want = LEVEL_NEON;
+    }
+    // Never go above what the CPU supports, or across architectures.
+    if (detected == LEVEL_NEON) {
+        return want == LEVEL_NEON ? LEVEL_NEON : LEVEL_SCALAR;
+    }
+    if (want == LEVEL_NEON) {
+        return LEVEL_SCALAR;
+    }
+    return want < detected ? want : detected;
+}
+
+void json5_simd_init(void) {
+    int level = requested_level(detect_level());
+    switch (level) {
+#if defined(SIMD_X86)
+        case LEVEL_AVX512:
+            json5_simd.skip_blanks = skip_blanks_avx512;
+            json5_simd.find_string_special = find_string_special_avx512;
+            json5_simd.find_escape = find_escape_avx512;
+            json5_simd.name = "avx512";
+            return;
+        case LEVEL_AVX2:
+            json5_simd.skip_blanks = skip_blanks_avx2;
+            json5_simd.find_string_special = find_string_special_avx2;
+            json5_simd.find_escape = find_escape_avx2;
+            json5_simd.name = "avx2";
+            return;
+        case LEVEL_SSE2:
+            json5_simd.skip_blanks = skip_blanks_sse2;
+            json5_simd.find_string_special = find_string_special_sse2;
+            json5_simd.find_escape = find_escape_sse2;
+            json5_simd.name = "sse2";
+            return;
+#elif defined(SIMD_NEON)
+        case LEVEL_NEON:
+            json5_simd.skip_blanks = skip_blanks_neon;
+            json5_simd.find_string_special = find_string_special_neon;
+            json5_simd.find_escape = find_escape_neon;
+            json5_simd.name = "neon";
+            return;
+#endif
+        default:
+            json5_simd.skip_blanks = skip_blanks_scalar;
+            json5_simd.find_string_special = find_string_special_scalar;
+            json5_simd.find_escape = find_escape_scalar;
+            json5_simd.name = "scalar";
+            return;
+    }
+}
+
+#ifdef SIMD_AUTO_INIT
+__attribute__((constructor))
+static void simd_auto_init(void) {
+    json5_simd_init();
+}
+#endif
@@ -0,0 +1,47 @@
+#ifndef QJSON5_SIMD_H
+#define QJSON5_SIMD_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Byte-scanning kernels shared by the scanner, transcoder and dumper.
+ * Each is compiled for several ISA levels and the best one supported by
+ * the running CPU is picked once by json5_simd_init(). All kernels take a
+ * [p, end) span and return end if nothing matches.
+ */
+typedef struct {
+    /* First byte that is not whitespace (0x01..0x20; NUL is not). */
+    const char* (*skip_blanks)(const char *p, const char *end);
+    /* First byte inside a string that is quote, '\\' or non-ASCII. */
+    const char* (*find_string_special)(const char *p, const char *end, char quote);
+    /* First byte that needs escaping on output: '"', '\\' or < 0x20. */
+    const char* (*find_escape)(const char *p, const char *end);
+    const char *name;
+} json5_simd_kernels;
+
+extern json5_simd_kernels json5_simd;
+
+/*
+ * json5_simd_init:
+ *   Selects the kernels for the running CPU. The QJSON5_SIMD environment
+ *   variable ("scalar", "sse2", "avx2", "avx512", "neon") caps the level;
+ *   any other non-empty value selects scalar.
+ *   With GCC/Clang (SIMD_AUTO_INIT) it already ran when the library was
+ *   loaded, before any thread could use the kernels; calling it again
+ *   while other threads parse is a data race.
+ */
+void json5_simd_init(void);
+
+#if defined(__GNUC__) || defined(__clang__)
+#define SIMD_AUTO_INIT 1
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,36 @@
+from typing import IO, Any, Iterator, Optional, Union
+
+from .py_json5 import IterParser
+
+Source = Union[str, bytes, bytearray, memoryview, IO[str], IO[bytes]]
+
+
+def iterparse(source: Source, prefix: Optional[str] = None, buffer_size: int = 65536) -> Iterator[Any]:
+    """
+    Incrementally parse JSON5 from a file-like object (text or binary) or an
+    in-memory str/bytes, reading 'buffer_size' at a time.
+
+    Without a prefix, yields (path, event, value) tuples. Paths are dotted:
+    "" for the top-level value, the key inside objects and "item" inside
+    arrays. Events are start_map, map_key, end_map, start_array, end_array,
+    string, number, boolean and null.
+
+    With a prefix, yields each value found at that path fully built, e.g.
+    prefix="item" yields the elements of a top-level array one at a time.
+    Memory stays proportional to the largest such value, not the document.
+    """
+    if buffer_size < 1:
+        raise ValueError("buffer_size must be >= 1")
+    parser = IterParser(prefix)
+    if isinstance(source, (str, bytes, bytearray, memoryview)):
+        if isinstance(source, memoryview):
+            source = source.cast("B")
+        for start in range(0, len(source), buffer_size):
+            yield from parser.feed(source[start : start + buffer_size])
+    else:
+        while True:
+            block = source.read(buffer_size)
+            if not block:
+                break
+            yield from parser.feed(block)
+    yield from parser.close()
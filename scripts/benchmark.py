@@ -24,11 +24,18 @@ import statistics
 import string
 import time
 
-import json5
-import pyjson5
-
 import qjson5
 
+# Optional comparison libraries; missing ones are reported as skipped.
+try:
+    import json5
+except ImportError:
+    json5 = None
+try:
+    import pyjson5
+except ImportError:
+    pyjson5 = None
+
 random.seed(0)
 
 
@@ -119,10 +126,11 @@ def run_benchmark(
         ),
     ]
 
+    all_sets = ["SMALL", "MEDIUM", "LARGE"]
     libs = [
-        ("json5", dump_load_json5, ["SMALL", "MEDIUM", "LARGE"]),
+        ("json5", dump_load_json5, all_sets),
         ("builtin-json", dump_load_builtin_json, []),
-        ("pyjson5", dump_load_pyjson5, []),
+        ("pyjson5", dump_load_pyjson5, all_sets if pyjson5 is None else []),
         ("qjson5", dump_load_qjson5, []),
     ]
 
@@ -0,0 +1,98 @@
+"""
+Multi-threaded dump+load scaling benchmark for qjson5.
+
+Every thread runs the same number of dumps+loads round trips on its own
+copy of the data, so on a free-threaded interpreter (3.13t and later) the
+throughput should grow close to linearly with the thread count. With the
+GIL the threads take turns and the speedup stays near 1x.
+
+To run:
+    python3.13t scripts/benchmark_threads.py
+    python3.13t scripts/benchmark_threads.py --threads 1 2 4 8 --iterations 200
+"""
+
+import argparse
+import copy
+import os
+import random
+import string
+import sys
+import threading
+import time
+
+import qjson5
+
+random.seed(0)
+
+
+def random_string(length=8):
+    return "".join(random.choices(string.ascii_letters, k=length))
+
+
+def generate_records(count: int):
+    return [
+        {
+            "id": i,
+            "name": random_string(),
+            "score": random.random() * 100,
+            "active": bool(i % 2),
+            "tags": [random_string(4) for _ in range(3)],
+        }
+        for i in range(count)
+    ]
+
+
+def dump_load_qjson5(data, num_iterations: int):
+    for _ in range(num_iterations):
+        encoded = qjson5.dumps(data)
+        _ = qjson5.loads(encoded)
+
+
+def time_threads(num_threads: int, data, num_iterations: int) -> float:
+    """
+    Wall time for num_threads threads each doing num_iterations round trips.
+    """
+    barrier = threading.Barrier(num_threads + 1)
+    copies = [copy.deepcopy(data) for _ in range(num_threads)]
+
+    def worker(d):
+        barrier.wait()
+        dump_load_qjson5(d, num_iterations)
+
+    threads = [threading.Thread(target=worker, args=(d,)) for d in copies]
+    for t in threads:
+        t.start()
+    barrier.wait()
+    t0 = time.perf_counter()
+    for t in threads:
+        t.join()
+    return time.perf_counter() - t0
+
+
+def run_benchmark(thread_counts, num_records: int, num_iterations: int, num_repeats: int):
+    gil = getattr(sys, "_is_gil_enabled", lambda: True)()
+    print("==== qjson5 Multi-threaded Dump+Load Benchmark ====\n")
+    print(f"Python {sys.version.split()[0]}, GIL {'enabled' if gil else 'disabled'}, {os.cpu_count()} CPUs")
+    print(f"{num_records} records per document, {num_iterations} round trips per thread\n")
+
+    data = generate_records(num_records)
+    base = None
+    for n in thread_counts:
+        best = min(time_threads(n, data, num_iterations) for _ in range(num_repeats))
+        ops = n * num_iterations / best
+        base = base or ops
+        print(f"{n:3d} threads => {best * 1000:9.2f} ms, {ops:9.1f} round trips/s, speedup {ops / base:5.2f}x")
+
+
+if __name__ == "__main__":
+    cpus = os.cpu_count() or 1
+    default_threads = sorted({1, 2, 4, 8, cpus} & set(range(1, cpus + 1)))
+
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--threads", type=int, nargs="+", default=default_threads)
+    parser.add_argument("--records", type=int, default=1000)
+    parser.add_argument("--iterations", type=int, default=100)
+    parser.add_argument("--repeats", type=int, default=3)
+    args = parser.parse_args()
+
+    run_benchmark(args.threads, args.records, args.iterations, args.repeats)
@@ -0,0 +1,75 @@
+"""
+Profile-guided build of the qjson5 extension, trained on the benchmark corpus.
+
+Steps:
+    1) Build an instrumented extension  (QJSON5_PGO=generate)
+    2) Run loads/dumps/validate/transcode over the benchmark data sets
+    3) Rebuild using the collected profiles  (QJSON5_PGO=use)
+
+To run (GCC or Clang; Clang additionally needs llvm-profdata on PATH):
+    python scripts/pgo.py
+
+The optimized extension is left in place in qjson5/. Use
+`QJSON5_PGO=use pip install .` afterwards to install it the same way.
+"""
+
+import glob
+import os
+import shutil
+import subprocess
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+PGO_DIR = os.path.join(ROOT, "build", "pgo")
+
+
+def build(mode: str) -> None:
+    env = dict(os.environ, QJSON5_PGO=mode, QJSON5_PGO_DIR=PGO_DIR)
+    subprocess.run(
+        [sys.executable, "setup.py", "build_ext", "--inplace", "--force"],
+        cwd=ROOT,
+        env=env,
+        check=True,
+    )
+
+
+def train() -> None:
+    sys.path.insert(0, ROOT)
+    sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+    import qjson5
+    from benchmark import generate_data
+
+    for count, nested, iterations in [(10, 2, 1000), (100, 10, 50), (1000, 50, 2)]:
+        data = generate_data(count, nested)
+        for indent in (None, 2):
+            text = qjson5.dumps(data, indent=indent)
+            for _ in range(iterations):
+                qjson5.loads(text)
+                qjson5.dumps(data, indent=indent)
+                qjson5.validate(text)
+                qjson5.transcode(text, indent=indent)
+
+
+def merge_clang_profiles() -> None:
+    raw = glob.glob(os.path.join(PGO_DIR, "*.profraw"))
+    if raw:
+        subprocess.run(
+            ["llvm-profdata", "merge", "-o", os.path.join(PGO_DIR, "default.profdata"), *raw],
+            check=True,
+        )
+
+
+def main() -> None:
+    shutil.rmtree(PGO_DIR, ignore_errors=True)
+    os.makedirs(PGO_DIR)
+    build("generate")
+    subprocess.run([sys.executable, os.path.abspath(__file__), "--train"], cwd=ROOT, check=True)
+    merge_clang_profiles()
+    build("use")
+
+
+if __name__ == "__main__":
+    if "--train" in sys.argv:
+        train()
+    else:
+        main()
@@ -1,8 +1,39 @@
+import os
+
 from setuptools import Extension, setup
 
 with open("README.md", encoding="utf-8") as f:
     long_desc = f.read()
 
+# SIMD kernels (qjson5/simd.c) are built for several ISA levels via target
+# attributes and picked at import time, so no -march flag is needed here.
+# -ffast-math is deliberately not used: it changes float parsing results.
+compile_args = [
+    "-std=gnu17",
+    "-O3",
+    "-flto",
+    "-fomit-frame-pointer",
+    "-funroll-loops",
+    "-fstrict-aliasing",
+]
+link_args = []
+
+# Profile-guided build, driven by scripts/pgo.py:
+#   QJSON5_PGO=generate  instrumented build writing profiles to QJSON5_PGO_DIR
+#   QJSON5_PGO=use       optimized build reading them back
+pgo_mode = os.environ.get("QJSON5_PGO", "")
+pgo_dir = os.path.abspath(os.environ.get("QJSON5_PGO_DIR", os.path.join("build", "pgo")))
+if pgo_mode == "generate":
+    compile_args.append(f"-fprofile-generate={pgo_dir}")
+    link_args.append(f"-fprofile-generate={pgo_dir}")
+elif pgo_mode == "use":
+    profdata = os.path.join(pgo_dir, "default.profdata")
+    profile = profdata if os.path.exists(profdata) else pgo_dir
+    compile_args += [f"-fprofile-use={profile}", "-fprofile-correction", "-Wno-missing-profile"]
+    link_args.append(f"-fprofile-use={profile}")
+elif pgo_mode:
+    raise SystemExit(f"QJSON5_PGO must be 'generate' or 'use', got {pgo_mode!r}")
+
 setup(
     name="qjson5",
     version="1.0.3",
@@ -24,6 +55,7 @@ setup(
         "Programming Language :: Python :: 3",
         "Programming Language :: C",
         "Programming Language :: Python :: Implementation :: CPython",
+        "Programming Language :: Python :: Free Threading :: 2 - Beta",
         "License :: OSI Approved :: MIT License",
         "Operating System :: OS Independent",
         "Topic :: Software Development :: Libraries",
@@ -32,19 +64,14 @@ setup(
         Extension(
             name="qjson5.py_json5",
             sources=[
+                "qjson5/json5_core.c",
                 "qjson5/json5.c",
+                "qjson5/simd.c",
                 "qjson5/py_json5.c",
             ],
             include_dirs=["qjson5"],
-            extra_compile_args=[
-                "-std=gnu17",
-                "-Ofast",
-                "-flto",
-                "-fomit-frame-pointer",
-                "-funroll-loops",
-                "-ffast-math",
-                "-fstrict-aliasing",
-            ],
+            extra_compile_args=compile_args,
+            extra_link_args=link_args,
         )
     ],
     extras_require={"dev": ["pytest"]},
@@ -0,0 +1,195 @@
+/*
+ * Tests for the Python-free core (libqjson5), built and run by `make check`.
+ */
+#include "json5_core.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int failures = 0;
+
+#define CHECK(cond)                                                        \
+    do {                                                                   \
+        if (!(cond)) {                                                     \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n",                   \
+                    __FILE__, __LINE__, #cond);                            \
+            failures++;                                                    \
+        }                                                                  \
+    } while (0)
+
+/*
+ * recorder:
+ * Writes every event into a compact string, e.g. {k:a[n1 s:x]}; strings
+ * and keys are decoded, with non-ASCII code points as \u{hex}.
+ */
+typedef struct {
+    char out[4096];
+    size_t len;
+    int abort_on_number;
+} recorder;
+
+static void put(recorder *r, const char *s) {
+    size_t n = strlen(s);
+    if (r->len + n < sizeof(r->out)) {
+        memcpy(r->out + r->len, s, n + 1);
+        r->len += n;
+    }
+}
+
+static void put_text(recorder *r, const json5_token *tok) {
+    uint32_t *cps = (uint32_t*)malloc((tok->length + 1) * sizeof(uint32_t));
+    json5_decode_string(tok, cps, 4);
+    for (size_t i = 0; i < tok->length; i++) {
+        char tmp[16];
+        if (cps[i] < 0x80) {
+            snprintf(tmp, sizeof(tmp), "%c", (char)cps[i]);
+        } else {
+            snprintf(tmp, sizeof(tmp), "\\u{%x}", (unsigned)cps[i]);
+        }
+        put(r, tmp);
+    }
+    free(cps);
+}
+
+static int on_start_object(void *ctx) { put((recorder*)ctx, "{"); return 0; }
+static int on_end_object(void *ctx) { put((recorder*)ctx, "}"); return 0; }
+static int on_start_array(void *ctx) { put((recorder*)ctx, "["); return 0; }
+static int on_end_array(void *ctx) { put((recorder*)ctx, "]"); return 0; }
+
+static int on_key(void *ctx, const json5_token *tok) {
+    put((recorder*)ctx, "k:");
+    put_text((recorder*)ctx, tok);
+    return 0;
+}
+
+static int on_string(void *ctx, const json5_token *tok) {
+    put((recorder*)ctx, " s:");
+    put_text((recorder*)ctx, tok);
+    return 0;
+}
+
+static int on_number(void *ctx, const json5_token *tok) {
+    recorder *r = (recorder*)ctx;
+    char tmp[64];
+    if (tok->flags & JSON5_FLOAT) {
+        snprintf(tmp, sizeof(tmp), " d%g", tok->d);
+    } else {
+        snprintf(tmp, sizeof(tmp), " n%lld", tok->i);
+    }
+    put(r, tmp);
+    return r->abort_on_number;
+}
+
+static int on_boolean(void *ctx, int value) {
+    put((recorder*)ctx, value ? " t" : " f");
+    return 0;
+}
+
+static int on_null(void *ctx) {
+    put((recorder*)ctx, " z");
+    return 0;
+}
+
+static const json5_callbacks recording = {
+    on_start_object, on_end_object, on_start_array, on_end_array,
+    on_key, on_string, on_number, on_boolean, on_null,
+};
+
+static const char doc[] =
+    "// comment\n"
+    "{ a: [1, -0x10, .5, 'x\\u00e9'], \"b\\u0063\": { d: null, e: true, }, /* c */ f: 1e300 }";
+static const char events[] =
+    "{k:a[ n1 n-16 d0.5 s:x\\u{e9}]k:bc{k:d zk:e t}k:f d1e+300}";
+
+static void test_parse(void) {
+    recorder r = {0};
+    json5_error err;
+    CHECK(json5_parse(doc, strlen(doc), &recording, &r, &err) == JSON5_OK);
+    CHECK(strcmp(r.out, events) == 0);
+
+    // Callbacks may be left out.
+    json5_callbacks none = {0};
+    CHECK(json5_parse(doc, strlen(doc), &none, NULL, &err) == JSON5_OK);
+    CHECK(json5_validate(doc, strlen(doc), &err) == JSON5_OK);
+}
+
+static void test_errors(void) {
+    recorder r = {0};
+    json5_error err;
+    const char *bad = "{\n  a: 1,\n  b: x\n}";
+    CHECK(json5_parse(bad, strlen(bad), &recording, &r, &err) == JSON5_ERR_SYNTAX);
+    CHECK(strcmp(err.msg, "Unexpected token") == 0);
+    CHECK(err.offset == 15 && err.line == 3 && err.column == 6);
+
+    CHECK(json5_validate("[1, 2", 5, &err) == JSON5_ERR_TRUNCATED);
+
+    // A non-zero return from a callback stops the parse.
+    recorder stop = {0};
+    stop.abort_on_number = 1;
+    CHECK(json5_parse("[1, 2, 3]", 9, &recording, &stop, &err) == JSON5_ERR_ABORTED);
+    CHECK(strcmp(stop.out, "[ n1") == 0);
+}
+
+/*
+ * Feeds doc in blocks of every size, passing the unconsumed tail back
+ * in front of the next block, and checks the events match json5_parse.
+ */
+static void test_incremental(void) {
+    size_t total = strlen(doc);
+    for (size_t block = 1; block <= total; block++) {
+        recorder r = {0};
+        json5_error err;
+        json5_parser *ps = json5_parser_new(&recording, &r);
+        CHECK(ps != NULL);
+        char buf[sizeof(doc)];
+        size_t have = 0;
+        size_t fed = 0;
+        int rc = JSON5_NEED_MORE;
+        while (rc == JSON5_NEED_MORE) {
+            size_t n = total - fed < block ? total - fed : block;
+            memcpy(buf + have, doc + fed, n);
+            have += n;
+            fed += n;
+            size_t consumed = 0;
+            rc = json5_parser_feed(ps, buf, have, fed == total, &consumed, &err);
+            memmove(buf, buf + consumed, have - consumed);
+            have -= consumed;
+        }
+        CHECK(rc == JSON5_OK);
+        CHECK(strcmp(r.out, events) == 0);
+        json5_parser_free(ps);
+    }
+
+    json5_error err;
+    recorder r = {0};
+    json5_parser *ps = json5_parser_new(&recording, &r);
+    size_t consumed = 0;
+    CHECK(json5_parser_feed(ps, "[1,\n 2,", 7, 0, &consumed, &err) == JSON5_NEED_MORE);
+    CHECK(json5_parser_feed(ps, " x]", 3, 1, &consumed, &err) == JSON5_ERR_SYNTAX);
+    CHECK(err.offset == 8 && err.line == 2 && err.column == 5);
+    json5_parser_free(ps);
+}
+
+static void test_transcode(void) {
+    char *out = NULL;
+    size_t len = 0;
+    json5_error err;
+    const char *src = "{ a: 0x10, 'b': [+1, .5,], }";
+    CHECK(json5_transcode(src, strlen(src), 0, 0, &out, &len, &err) == JSON5_OK);
+    CHECK(out && len == strlen("{\"a\": 16, \"b\": [1, 0.5]}"));
+    CHECK(out && memcmp(out, "{\"a\": 16, \"b\": [1, 0.5]}", len) == 0);
+    free(out);
+}
+
+int main(void) {
+    test_parse();
+    test_errors();
+    test_incremental();
+    test_transcode();
+    if (failures) {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("test_core: all checks passed\n");
+    return 0;
+}
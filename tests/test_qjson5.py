@@ -1,4 +1,9 @@
 import io
+import json
+import os
+import shutil
+import subprocess
+import sys
 import textwrap
 
 import pytest
@@ -283,6 +288,36 @@ def test_unicode_characters():
     assert "emoji" in parsed
 
 
+def test_unicode_escape_decoding():
+    data = r"""
+    {
+      "latin": "Hello \u00F1 World",
+      "bmp": "\u65e5\u672c",
+      "pair": "Smile \uD83D\uDE03",
+      "lone": "\uD800",
+      "hex": "\x41\x62",
+      "nul": "a\0b",
+      "vtab": "\v",
+      "raw": 'Grüße 日本 😃',
+    }
+    """
+    parsed = qjson5.loads(data)
+    assert parsed["latin"] == "Hello \u00f1 World"
+    assert parsed["bmp"] == "\u65e5\u672c"
+    assert parsed["pair"] == "Smile \U0001F603"
+    assert parsed["lone"] == "\ud800"
+    assert parsed["hex"] == "Ab"
+    assert parsed["nul"] == "a\x00b"
+    assert parsed["vtab"] == "\x0b"
+    assert parsed["raw"] == "Grüße 日本 😃"
+
+
+def test_invalid_escapes():
+    for data in [r'"\u12"', r'"\uZZZZ"', r'"\x4"']:
+        with pytest.raises(ValueError):
+            qjson5.loads(data)
+
+
 def test_deeply_nested():
     nested = "0"
     for _ in range(50):
@@ -428,3 +463,321 @@ No \\n's!",
     assert parsed["trailingComma"] == "in objects"
     assert parsed["andIn"] == ["arrays"]
     assert parsed["backwardsCompatible"] == "with JSON"
+
+
+def test_load_file_cache(tmp_path):
+    path = tmp_path / "config.json5"
+    path.write_text("{ a: 1, list: [1, 2], nested: { b: 'x' } }")
+
+    cache = qjson5.Cache(maxsize=4)
+    first = qjson5.load_file(path, cache=cache)
+    second = qjson5.load_file(path, cache=cache)
+    assert first is second
+    assert first == {"a": 1, "list": (1, 2), "nested": {"b": "x"}}
+    assert cache.info() == qjson5.CacheInfo(hits=1, misses=1, maxsize=4, currsize=1)
+
+    with pytest.raises(TypeError):
+        first["a"] = 2
+    with pytest.raises(TypeError):
+        first["nested"].update(b="y")
+    assert qjson5.loads(qjson5.dumps(first)) == {"a": 1, "list": [1, 2], "nested": {"b": "x"}}
+
+    import copy
+    import pickle
+
+    for clone in (copy.copy(first), copy.deepcopy(first), pickle.loads(pickle.dumps(first))):
+        assert clone == first
+        assert type(clone) is qjson5.FrozenDict
+        assert type(clone["nested"]) is qjson5.FrozenDict
+
+    path.write_text("{ a: 2 }")
+    third = qjson5.load_file(path, cache=cache)
+    assert third == {"a": 2}
+    assert cache.info().misses == 2
+
+
+def test_load_file_cache_lru(tmp_path):
+    cache = qjson5.Cache(maxsize=2, frozen=False)
+    paths = []
+    for i in range(3):
+        path = tmp_path / f"{i}.json5"
+        path.write_text(f"[{i}]")
+        paths.append(path)
+
+    assert qjson5.load_file(paths[0], cache=cache) == [0]
+    assert qjson5.load_file(paths[1], cache=cache) == [1]
+    assert qjson5.load_file(paths[0], cache=cache) == [0]
+    assert qjson5.load_file(paths[2], cache=cache) == [2]
+    assert len(cache) == 2
+    assert paths[0] in cache
+    assert paths[1] not in cache
+
+    cache.clear()
+    assert cache.info() == qjson5.CacheInfo(hits=0, misses=0, maxsize=2, currsize=0)
+    assert qjson5.load_file(paths[1]) == [1]
+
+
+def test_validate():
+    qjson5.validate("{ a: [1, .5, 0xFF, 'x',], /* c */ b: null }")
+    qjson5.validate(b'{"a": "\\u00e9"}')
+    qjson5.validate(bytearray(b"[1, 2]"))
+    qjson5.validate(memoryview(b"[1, 2] trailing")[:6])
+
+    with pytest.raises(qjson5.JSON5DecodeError) as exc:
+        qjson5.validate("{\n  a: 1,\n  b: x\n}")
+    assert isinstance(exc.value, ValueError)
+    assert exc.value.msg == "Unexpected token"
+    assert (exc.value.pos, exc.value.lineno, exc.value.colno) == (15, 3, 6)
+
+    with pytest.raises(qjson5.JSON5DecodeError) as exc:
+        qjson5.validate(memoryview(b'["ab\\u12"]')[:8])
+    assert exc.value.msg == "Invalid \\u escape"
+
+
+def test_validate_matches_loads():
+    cases = [
+        '{"a": 123 ',
+        '{"a": 1} extra',
+        '{"a" 123}',
+        '{ 123key: "value" }',
+        '{"a": "Hello}',
+        "[1, 2, 3",
+        '{"a": .}',
+        '{"a": Infinity}',
+        "[1, 2,]",
+        "{a: {b: [[], {}]},}",
+        "",
+        "[1,\x002]",
+        b"[1]\x00",
+    ]
+    for data in cases:
+        try:
+            qjson5.loads(data)
+            valid = True
+        except ValueError:
+            valid = False
+        if valid:
+            qjson5.validate(data)
+        else:
+            with pytest.raises(qjson5.JSON5DecodeError):
+                qjson5.validate(data)
+    # Embedded or trailing NUL must not pass as whitespace.
+    for data in ("[1,\x002]", b"[1]\x00"):
+        with pytest.raises(qjson5.JSON5DecodeError):
+            qjson5.validate(data)
+
+
+def test_transcode_to_json():
+    data = textwrap.dedent(r"""{
+      // comments
+      unquoted: 'and you can quote me on that',
+      singleQuotes: 'I can use "double quotes" here',
+      lineBreaks: "Look, Mom! \
+No \\n's!",
+      hexadecimal: 0xdecaf,
+      leadingDecimalPoint: .8675309, andTrailing: 8675309.,
+      positiveSign: +1,
+      trailingComma: 'in objects', andIn: ['arrays',],
+      "backwardsCompatible": "with JSON",
+    }
+    """)
+    text = qjson5.transcode(data, indent=4)
+    assert json.loads(text) == {
+        "unquoted": "and you can quote me on that",
+        "singleQuotes": 'I can use "double quotes" here',
+        "lineBreaks": "Look, Mom! No \\n's!",
+        "hexadecimal": 912559,
+        "leadingDecimalPoint": 0.8675309,
+        "andTrailing": 8675309,
+        "positiveSign": 1,
+        "trailingComma": "in objects",
+        "andIn": ["arrays"],
+        "backwardsCompatible": "with JSON",
+    }
+    assert text == qjson5.dumps(json.loads(text), indent=4)
+    assert qjson5.transcode(b"[1, {a: null}, '\\u00e9',]") == '[1, {"a": null}, "é"]'
+    for n in (0, 0xFF, 2**64 - 1, 2**64 + 1, 3**200):
+        assert qjson5.transcode("[0x%x, -0x000%X]" % (n, n)) == "[%d, -%d]" % (n, n)
+
+
+def test_transcode_to_json5():
+    data = "{ a: 0x10, 'b': [+1, .5,], /* c */ }"
+    assert qjson5.transcode(data, target="json5") == '{a: 0x10, "b": [+1, .5]}'
+    with pytest.raises(ValueError):
+        qjson5.transcode(data, target="yaml")
+    with pytest.raises(qjson5.JSON5DecodeError):
+        qjson5.transcode("{ a: 1 ")
+
+
+def test_long_strings_with_specials():
+    # Exercise the vector kernels across block boundaries.
+    for n in range(0, 130, 3):
+        for special in ['"', "\\", "\x01", "é", "'", "\n"]:
+            body = "a" * n + special + "b" * (n % 7)
+            obj = [body, {"k" * (n + 1): body}]
+            text = qjson5.dumps(obj)
+            assert json.loads(text) == obj
+            assert qjson5.loads(text) == obj
+            assert qjson5.transcode(text) == text
+            qjson5.validate(json.dumps(obj, indent=n % 9))
+            src = "['" + body.replace("\\", "\\\\").replace("'", "\\'").replace("\n", "\\n") + "']"
+            assert json.loads(qjson5.transcode(src)) == [body]
+            with pytest.raises(qjson5.JSON5DecodeError):
+                qjson5.validate(src[:-2])
+
+
+SIMD_LEVELS = ["scalar", "sse2", "avx2", "avx512"]
+
+
+@pytest.mark.parametrize("level", SIMD_LEVELS)
+def test_simd_levels(level, tmp_path):
+    # Re-run the suite with the kernels capped at each level the CPU has.
+    # The children run outside the source tree so they import the same
+    # (possibly installed) package as this process.
+    top = qjson5.py_json5.simd_level
+    if level != "scalar" and (top not in SIMD_LEVELS or SIMD_LEVELS.index(level) > SIMD_LEVELS.index(top)):
+        pytest.skip(f"CPU lacks {level}")
+    env = dict(os.environ, QJSON5_SIMD=level, PYTHONPATH=os.path.dirname(os.path.dirname(qjson5.__file__)))
+    out = subprocess.run(
+        [sys.executable, "-c", "import qjson5; print(qjson5.py_json5.simd_level)"],
+        cwd=tmp_path, env=env, capture_output=True, text=True, check=True,
+    )
+    assert out.stdout.strip() == level
+    run = subprocess.run(
+        [sys.executable, "-m", "pytest", "-q", "-p", "no:cacheprovider", os.path.abspath(__file__),
+         "-k", "not test_simd_levels and not test_c_library"],
+        cwd=tmp_path, env=env, capture_output=True, text=True,
+    )
+    assert run.returncode == 0, run.stdout + run.stderr
+
+
+def test_c_library():
+    # Builds libqjson5 and links tests/test_core.c against it.
+    if not shutil.which("make") or not (shutil.which("cc") or os.environ.get("CC")):
+        pytest.skip("no C toolchain")
+    root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    run = subprocess.run(["make", "-s", "check"], cwd=root, capture_output=True, text=True)
+    assert run.returncode == 0, run.stdout + run.stderr
+
+
+def test_loads_buffers_and_error_position():
+    assert qjson5.loads(b"{ a: [1, 'x'] }") == {"a": [1, "x"]}
+    assert qjson5.loads(bytearray('"é"', "utf-8")) == "é"
+    assert qjson5.loads(memoryview(b"[1, 2] trailing")[:6]) == [1, 2]
+
+    with pytest.raises(qjson5.JSON5DecodeError) as exc:
+        qjson5.loads("{\n  a: 1,\n  b: x\n}")
+    assert exc.value.msg == "Unexpected token"
+    assert (exc.value.pos, exc.value.lineno, exc.value.colno) == (15, 3, 6)
+
+    # NUL is not whitespace, including inside runs the SIMD kernels skip.
+    for data in ("[1,\x00 2]", b"[1]\x00", "[1," + " " * 100 + "\x00" + " " * 100 + "2]"):
+        with pytest.raises(qjson5.JSON5DecodeError):
+            qjson5.loads(data)
+
+
+def test_iterparse_events():
+    data = "{ a: [1, 'x'], // c\n b: { c: null, d: true } }"
+    assert list(qjson5.iterparse(data, buffer_size=3)) == [
+        ("", "start_map", None),
+        ("", "map_key", "a"),
+        ("a", "start_array", None),
+        ("a.item", "number", 1),
+        ("a.item", "string", "x"),
+        ("a", "end_array", None),
+        ("", "map_key", "b"),
+        ("b", "start_map", None),
+        ("b", "map_key", "c"),
+        ("b.c", "null", None),
+        ("b", "map_key", "d"),
+        ("b.d", "boolean", True),
+        ("b", "end_map", None),
+        ("", "end_map", None),
+    ]
+
+
+def test_iterparse_items():
+    records = [{"id": i, "name": "né%d" % i, "tags": ["a", {"b": [i]}]} for i in range(50)]
+    text = qjson5.dumps({"meta": {"n": 50}, "records": records})
+    for size in (1, 5, 4096):
+        assert list(qjson5.iterparse(io.BytesIO(text.encode()), prefix="records.item", buffer_size=size)) == records
+        assert list(qjson5.iterparse(io.StringIO(text), prefix="meta.n", buffer_size=size)) == [50]
+    assert list(qjson5.iterparse(b"[1, [2], {a: 3}]", prefix="item")) == [1, [2], {"a": 3}]
+    assert list(qjson5.iterparse("[1, 2]", prefix="")) == [[1, 2]]
+
+
+def test_iterparse_errors():
+    with pytest.raises(qjson5.JSON5DecodeError) as exc:
+        list(qjson5.iterparse(io.StringIO('[1, 2, "abc'), prefix="item", buffer_size=2))
+    assert exc.value.msg == "Unterminated string"
+    assert exc.value.pos == 7
+
+    items = qjson5.iterparse(io.StringIO("[1,\n 2,\n x]"), prefix="item", buffer_size=4)
+    assert next(items) == 1
+    with pytest.raises(qjson5.JSON5DecodeError) as exc:
+        list(items)
+    assert (exc.value.msg, exc.value.pos, exc.value.lineno, exc.value.colno) == ("Unexpected token", 9, 3, 2)
+
+
+def test_concurrent_use():
+    import threading
+
+    records = [{"id": i, "name": "n%d" % i, "tags": [i, i * 0.5, None]} for i in range(200)]
+    text = qjson5.dumps(records)
+    shared = list(range(100))
+    errors = []
+
+    def worker(n):
+        try:
+            for _ in range(20):
+                assert qjson5.loads(text) == records
+                assert qjson5.loads(qjson5.dumps(records, indent=n % 3)) == records
+                assert list(qjson5.iterparse(text.encode(), prefix="item", buffer_size=97)) == records
+                # Another thread resizes this list while it is being dumped.
+                shared.append(n)
+                del shared[-1]
+                assert qjson5.dumps(shared).startswith("[0, 1")
+        except Exception as e:
+            errors.append(e)
+
+    threads = [threading.Thread(target=worker, args=(n,)) for n in range(8)]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+    assert errors == []
+
+
+def test_loads_columnar():
+    from array import array
+
+    text = "{ rows: [{id: 1, name: 'a', v: 0.5}, {'id': 2, \"name\": 'b', v: 2}], tags: [] }"
+    assert qjson5.loads(text, columnar=True) == {"rows": {"id": [1, 2], "name": ["a", "b"], "v": [0.5, 2]}, "tags": []}
+    packed = qjson5.loads(text, columnar="packed")["rows"]
+    assert packed["id"] == array("q", [1, 2])
+    assert packed["v"] == array("d", [0.5, 2.0])
+    assert packed["name"] == ["a", "b"]
+
+    # Anything but uniform records falls back to the plain result.
+    for text in ("[{a: 1, b: 2}, {a: 3}]", "[{a: 1}, {b: 2}]", "[{a: 1}, 2]", "[{a: 1, a: 2}, {a: 3}]", "[{}, {}]"):
+        for mode in (True, "packed"):
+            assert qjson5.loads(text, columnar=mode) == qjson5.loads(text)
+    assert qjson5.loads("[{a: 1}, {a: 'x'}, {a: 0x7fffffffffffffff}]", columnar="packed") == {"a": [1, "x", 2**63 - 1]}
+    with pytest.raises(ValueError):
+        qjson5.loads("[]", columnar="lists")
+
+
+def test_dumps_dict_mutated_while_dumping():
+    class Key:
+        def __init__(self, d):
+            self.d = d
+
+        def __str__(self):
+            self.d.clear()
+            return '"k"'
+
+    for _ in range(50):
+        d = {}
+        d[Key(d)] = ["x" * 10, {"y": [1.5]}]
+        d["b"] = "z"
+        assert qjson5.loads(qjson5.dumps(d)) == {"k": ["xxxxxxxxxx", {"y": [1.5]}]}